@@ -0,0 +1,43 @@
+#include <limits>
+
+#include "../tiny-logger.h"
+using namespace tiny;
+
+/// Benchmark Settings
+constexpr int RECORDS = 3000000;
+constexpr int RUNS = 3;
+
+/**
+ * Logs records of mixed arguments through the given sink, buffering until an error.
+ * @param sink                          Sink records are written to.
+ * @returns                             Nanoseconds per record.
+ */
+double measure(const std::shared_ptr<Sink>& sink) {
+    Logger::Options opts;
+    opts.prompt = "[{sev}] ";
+    opts.sinks = {sink};
+    opts.flushOn = Logger::ERROR;
+    opts.color = false;
+    Logger logger(opts);
+
+    const auto start = std::chrono::steady_clock::now();
+    for (int ii = 0; ii < RECORDS; ii++) logger.log(Logger::INFO, "order @ side @ filled @ at @ venue @", ii, 'B', ii * 7u, 101.25 + ii * 0.01, "XNAS");
+    sink->flush();
+    return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / RECORDS;
+}
+
+/// Compares writing through iostreams with writing straight to the descriptor. Records go to
+/// standard output, so redirect it to a file, and results are printed to standard error.
+int main() {
+    std::ios::sync_with_stdio(false);
+
+    double stream = std::numeric_limits<double>::max(), direct = stream;
+    for (int ii = 0; ii < RUNS; ii++) {
+        stream = std::min(stream, measure(std::make_shared<StreamSink>(std::cout)));
+        direct = std::min(direct, measure(std::make_shared<FdSink>()));
+    }
+
+    std::fprintf(stderr, "%d records, best of %d, ns per record\n", RECORDS, RUNS);
+    std::fprintf(stderr, "  StreamSink(std::cout)  %6.1f\n", stream);
+    std::fprintf(stderr, "  FdSink                 %6.1f\n", direct);
+}
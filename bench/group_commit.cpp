@@ -0,0 +1,86 @@
+#include "../tiny-logger.h"
+using namespace tiny;
+
+/// Benchmark Settings
+constexpr std::chrono::seconds DURATION{2};
+constexpr int RUNS = 3;
+
+/// Sink running its own `fdatasync` for every record synced, for comparison with group commit.
+class SyncEachSink : public Sink {
+   public:
+    explicit SyncEachSink(const std::string& path) : m_fd(::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_APPEND | O_CLOEXEC, 0644)) {
+        if (m_fd < 0) throw std::system_error(errno, std::generic_category(), "open " + path);
+    }
+
+    ~SyncEachSink() { ::close(m_fd); }
+
+    void write(const Logger::Severity&, const char* data, size_t len) override {
+        std::lock_guard<std::mutex> guard(m_lock);
+        if (::write(m_fd, data, len) < 0) {}
+    }
+
+    void sync() override {
+        std::lock_guard<std::mutex> guard(m_lock);
+        ::fdatasync(m_fd);
+    }
+
+   private:
+    int m_fd;
+    std::mutex m_lock;
+};
+
+/**
+ * Logs errors from the given number of threads for a while, each waiting for its record to be on the disk.
+ * @param sink                          Sink records are written to.
+ * @param committers                    Threads logging.
+ * @returns                             Records committed per second.
+ */
+double measure(const std::shared_ptr<Sink>& sink, int committers) {
+    Logger::Options opts;
+    opts.sinks = {sink};
+    opts.syncOn = Logger::ERROR;
+    opts.color = false;
+    Logger logger(opts);
+
+    std::atomic<bool> stop{false};
+    std::atomic<uint64_t> committed{0};
+    std::vector<std::thread> threads;
+    for (int ii = 0; ii < committers; ii++)
+        threads.emplace_back([&, ii] {
+            uint64_t count = 0;
+            while (!stop.load(std::memory_order_relaxed)) logger.log(Logger::ERROR, "audit @ record @", ii, count++);
+            committed += count;
+        });
+
+    std::this_thread::sleep_for(DURATION);
+    stop = true;
+    for (std::thread& thread : threads) thread.join();
+    return committed.load() / std::chrono::duration<double>(DURATION).count();
+}
+
+/// Compares a durable `FileSink`, whose background thread runs one `fdatasync` for every caller
+/// waiting, with a sink syncing once per record. Files are written into the given directory, which
+/// should be on the storage being measured.
+int main(int argc, char** argv) {
+    const std::string dir = argc > 1 ? argv[1] : ".";
+    const std::string path = dir + "/bench-commit.log";
+
+    std::fprintf(stderr, "ERROR records with syncOn = ERROR, %llds runs, best of %d, records per second\n", static_cast<long long>(DURATION.count()), RUNS);
+    std::fprintf(stderr, "  committers   group commit   fdatasync per record\n");
+    for (const int committers : {1, 8, 64}) {
+        double group = 0, each = 0;
+        for (int ii = 0; ii < RUNS; ii++) {
+            ::unlink(path.c_str());
+            FileSink::Options file;
+            file.path = path;
+            file.durable = true;
+
+            group = std::max(group, measure(std::make_shared<FileSink>(file), committers));
+            each = std::max(each, measure(std::make_shared<SyncEachSink>(path), committers));
+        }
+
+        std::fprintf(stderr, "  %10d   %12.0f   %20.0f\n", committers, group, each);
+    }
+
+    ::unlink(path.c_str());
+}
@@ -0,0 +1,65 @@
+#include <limits>
+
+#include "../tiny-logger.h"
+using namespace tiny;
+
+/// Benchmark Settings
+constexpr int RECORDS = 2000000;
+constexpr int RUNS = 3;
+
+/**
+ * Logs records through the given sink.
+ * @param sink                          Sink records are written to.
+ * @param flushOn                       Least severe records flushed as they are written.
+ * @returns                             Nanoseconds per record.
+ */
+double measure(const std::shared_ptr<Sink>& sink, Logger::Severity flushOn) {
+    Logger::Options opts;
+    opts.sinks = {sink};
+    opts.flushOn = flushOn;
+    opts.color = false;
+    Logger logger(opts);
+
+    const auto start = std::chrono::steady_clock::now();
+    for (int ii = 0; ii < RECORDS; ii++) logger.log(Logger::INFO, "order @ filled @ shares at @", ii, ii * 7, 101.25);
+    sink->flush();
+    return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / RECORDS;
+}
+
+/// Compares `std::cout`, a `FileSink` writing with `write` and a `UringSink`, with buffered output
+/// and with every record flushed. Files are written into the given directory, which should be on the
+/// storage being measured, and standard output should be redirected to a file there too.
+int main(int argc, char** argv) {
+#if defined(__linux__) && defined(__NR_io_uring_setup)
+    std::ios::sync_with_stdio(false);
+    const std::string dir = argc > 1 ? argv[1] : ".";
+
+    std::fprintf(stderr, "%d records, best of %d, ns per record\n", RECORDS, RUNS);
+    std::fprintf(stderr, "                   std::cout   FileSink  UringSink\n");
+    for (const Logger::Severity flushOn : {Logger::ERROR, Logger::TRACE}) {
+        double results[3];
+        std::fill(std::begin(results), std::end(results), std::numeric_limits<double>::max());
+        for (int ii = 0; ii < RUNS; ii++) {
+            ::unlink((dir + "/bench-write.log").c_str());
+            ::unlink((dir + "/bench-uring.log").c_str());
+
+            FileSink::Options file;
+            file.path = dir + "/bench-write.log";
+            file.bufferSize = 256 * 1024;
+
+            results[0] = std::min(results[0], measure(std::make_shared<StreamSink>(std::cout), flushOn));
+            results[1] = std::min(results[1], measure(std::make_shared<FileSink>(file), flushOn));
+            results[2] = std::min(results[2], measure(std::make_shared<UringSink>(dir + "/bench-uring.log", 256 * 1024), flushOn));
+        }
+
+        std::fprintf(stderr, "  flushOn = %-7s %9.1f  %9.1f  %9.1f\n", flushOn == Logger::ERROR ? "ERROR" : "TRACE", results[0], results[1], results[2]);
+    }
+
+    ::unlink((dir + "/bench-write.log").c_str());
+    ::unlink((dir + "/bench-uring.log").c_str());
+#else
+    (void)argc;
+    (void)argv;
+    std::fprintf(stderr, "io_uring is not available here\n");
+#endif
+}
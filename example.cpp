@@ -16,17 +16,29 @@ int main() {
     Logger::initialise(opts);
 
     // and do a simple log instance
-    Logger::log(Logger::INFO, "Hello, World!");
+    TL_INFO("Hello, World!");
 
     // can print all generic types as per std::cout allows
-    Logger::log(Logger::WARNING, "@, @, @", 42, "'WOW!'", false);
+    TL_WARNING("@, @, @", 42, "'WOW!'", false);
 
     // can also print singular values without needing to format
-    Logger::logValue(123.456);
+    TL_VALUE(123.456);
 
     // derived loggable instances can also be logged simply
     TestLoggable test;
-    Logger::log(Logger::FATAL, "Test value: @", test);
+    TL_FATAL("Test value: @", test);
+
+    // separate logger instances keep their own options
+    Logger quiet({" * quiet ({sev}) | "});
+    quiet.setLevel(Logger::WARNING);
+    quiet.log(Logger::INFO, "Not printed!");
+    quiet.log(Logger::ERROR, "Printed with its own prompt.");
+
+    // named loggers inherit their level from their parent unless given their own
+    Logger::get("net").setLevel(Logger::ERROR);
+    Logger::get("net.http").log(Logger::WARNING, "Not printed either!");
+    Logger::get("net.http").setLevel(Logger::TRACE);
+    Logger::get("net.http").log(Logger::TRACE, "Printed!");
 
     return 0;
-}
\ No newline at end of file
+}
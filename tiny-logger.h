@@ -2,13 +2,621 @@
 #define TINY_LOGGER_H
 
 /// C++ STL
+#include <algorithm>
 #include <array>
+#include <atomic>
+#include <cctype>
+#include <charconv>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <fstream>
 #include <iostream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <sstream>
+#include <stdexcept>
+#include <streambuf>
 #include <string>
+#include <string_view>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+/// POSIX
+#if defined(__unix__)
+    #include <fcntl.h>
+    #include <signal.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+
+    #include <system_error>
+#endif
+
+/// Linux
+#if defined(__linux__)
+    #include <linux/futex.h>
+    #include <poll.h>
+    #include <pthread.h>
+    #include <sys/eventfd.h>
+    #include <sys/inotify.h>
+    #include <sys/ioctl.h>
+    #include <sys/syscall.h>
+    #include <sys/uio.h>
+#endif
+
+/// x86
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+    #include <cpuid.h>
+    #include <x86intrin.h>
+
+    #define TINY_LOGGER_TSC
+#endif
 
 /// Core Tiny Namespace.
 namespace tiny {
 
+    /*******************
+     *  RECORD BUFFER  *
+     *******************/
+
+    /// Growable buffer a record is formatted into before being written out. Doubles as a
+    /// stream buffer so anything printable through `std::ostream` can still be appended,
+    /// and keeps a rolling FNV-1a hash of everything appended since the last mark.
+    class RecordBuffer : public std::streambuf {
+       public:
+        /// Resets the buffer for a new record.
+        void clear() {
+            m_data.clear();
+            mark();
+        }
+
+        /// Restarts the rolling hash from the current end of the buffer.
+        void mark() {
+            m_hash = FNV_OFFSET;
+            m_mark = m_data.size();
+        }
+
+        /**
+         * Appends raw characters to the buffer, folding them into the rolling hash.
+         * @param str                           Characters to append.
+         * @param len                           Number of characters.
+         */
+        void append(const char* str, size_t len) {
+            for (size_t ii = 0; ii < len; ii++) m_hash = (m_hash ^ static_cast<unsigned char>(str[ii])) * FNV_PRIME;
+            m_data.append(str, len);
+        }
+
+        /// Appends a view to the buffer.
+        void append(std::string_view str) { append(str.data(), str.size()); }
+
+        /**
+         * Appends a value as `std::ostream` would with default formatting. Arithmetic values, characters
+         * and strings are formatted directly, skipping the stream's sentry, locale and virtual calls, and
+         * anything else is streamed.
+         * @param value                         Value to append.
+         */
+        template <typename T>
+        void print(const T& value) {
+            using U = std::decay_t<T>;
+            if constexpr (std::is_same_v<U, bool>) append(value ? "1" : "0", 1);
+            else if constexpr (std::is_same_v<U, char> || std::is_same_v<U, signed char> || std::is_same_v<U, unsigned char>) {
+                const char c = static_cast<char>(value);
+                append(&c, 1);
+            } else if constexpr (std::is_integral_v<U> || std::is_same_v<U, float> || std::is_same_v<U, double>) {
+                // six significant digits in the shorter of fixed or scientific, as streams default to
+                char digits[32];
+                std::to_chars_result res;
+                if constexpr (std::is_integral_v<U>) res = std::to_chars(digits, digits + sizeof(digits), value);
+                else res = std::to_chars(digits, digits + sizeof(digits), static_cast<double>(value), std::chars_format::general, 6);
+                append(digits, static_cast<size_t>(res.ptr - digits));
+            } else if constexpr (std::is_same_v<T, const char*> || std::is_same_v<T, char*>) {
+                if (value) append(std::string_view(value));
+            } else if constexpr (std::is_convertible_v<const T&, std::string_view>) append(std::string_view(value));
+            else m_stream << value;
+        }
+
+        /// Stream that appends into this buffer.
+        std::ostream& stream() { return m_stream; }
+
+        /// Buffer contents.
+        const char* data() const { return m_data.data(); }
+        size_t size() const { return m_data.size(); }
+
+        /// Rolling hash and length of everything appended since the last mark.
+        uint64_t hash() const { return m_hash; }
+        size_t hashedSize() const { return m_data.size() - m_mark; }
+
+       protected:
+        int_type overflow(int_type ch) override {
+            if (traits_type::eq_int_type(ch, traits_type::eof())) return traits_type::not_eof(ch);
+            const char c = traits_type::to_char_type(ch);
+            append(&c, 1);
+            return ch;
+        }
+
+        std::streamsize xsputn(const char* str, std::streamsize len) override {
+            append(str, static_cast<size_t>(len));
+            return len;
+        }
+
+       private:
+        static constexpr uint64_t FNV_OFFSET = 14695981039346656037ull;
+        static constexpr uint64_t FNV_PRIME = 1099511628211ull;
+
+        std::string m_data;
+        uint64_t m_hash = FNV_OFFSET;
+        size_t m_mark = 0;
+        std::ostream m_stream{this};
+    };
+
+    /*********
+     *  RCU  *
+     *********/
+
+    /// Read-copy-update support for publishing immutable snapshots. Readers mark themselves as active
+    /// in the current epoch while holding a `Guard`, which is wait-free. Writers swap in a new snapshot
+    /// and retire the old one, which is only deleted once every reader active before the swap has
+    /// finished. Writers never wait for readers; retired snapshots are reclaimed on later retirements.
+    class Rcu {
+        struct Reader;
+
+       public:
+        /// Marks the calling thread as reading for the lifetime of the guard. Guards may be nested.
+        class Guard {
+           public:
+            Guard() : m_reader(m_local()) {
+                if (m_reader.depth++ == 0) m_reader.epoch.store(m_state().epoch.load());
+            }
+
+            ~Guard() {
+                if (--m_reader.depth == 0) m_reader.epoch.store(0, std::memory_order_release);
+            }
+
+            Guard(const Guard&) = delete;
+            Guard& operator=(const Guard&) = delete;
+
+           private:
+            Reader& m_reader;
+        };
+
+        /**
+         * Publishes a new snapshot in place of the current one, retiring the old snapshot.
+         * @param slot                          Published snapshot.
+         * @param next                          Replacement snapshot, owned by the slot from now on.
+         */
+        template <typename T>
+        static void publish(std::atomic<const T*>& slot, const T* next) {
+            const T* prev = slot.exchange(next);
+            if (prev) retire(prev, [](const void* ptr) { delete static_cast<const T*>(ptr); });
+        }
+
+        /**
+         * Retires a snapshot no longer reachable by new readers, and reclaims every retired snapshot
+         * that no reader can still hold.
+         * @param ptr                           Retired snapshot.
+         * @param destroy                       Deleter for the snapshot.
+         */
+        static void retire(const void* ptr, void (*destroy)(const void*)) {
+            State& state = m_state();
+            const uint64_t epoch = state.epoch.fetch_add(1);
+
+            std::lock_guard<std::mutex> guard(state.lock);
+            state.retired.push_back({epoch, ptr, destroy});
+
+            // anything retired before the oldest active reader started can go
+            uint64_t oldest = UINT64_MAX;
+            for (Reader* reader = state.readers.load(); reader; reader = reader->next) {
+                const uint64_t active = reader->epoch.load();
+                if (active != 0) oldest = std::min(oldest, active);
+            }
+
+            auto kept = state.retired.begin();
+            for (auto& retired : state.retired) {
+                if (retired.epoch < oldest) retired.destroy(retired.ptr);
+                else *kept++ = retired;
+            }
+            state.retired.erase(kept, state.retired.end());
+        }
+
+       private:
+        /// Reader record, one per thread using guards. Records are recycled once their thread exits.
+        struct Reader {
+            std::atomic<uint64_t> epoch{0};
+            std::atomic<bool> used{true};
+            unsigned depth = 0;
+            Reader* next = nullptr;
+        };
+
+        /// Snapshot waiting for readers to move on.
+        struct Retired {
+            uint64_t epoch;
+            const void* ptr;
+            void (*destroy)(const void*);
+        };
+
+        /// Process-wide state, which readers only touch to read the epoch.
+        struct State {
+            std::atomic<uint64_t> epoch{1};
+            std::atomic<Reader*> readers{nullptr};
+            std::mutex lock;
+            std::vector<Retired> retired;
+        };
+
+        static State& m_state() {
+            static State* state = new State();
+            return *state;
+        }
+
+        /// Claims a reader record for the calling thread, and releases it when the thread exits.
+        struct Registration {
+            Reader* reader = nullptr;
+
+            Registration() {
+                State& state = m_state();
+                for (Reader* it = state.readers.load(); it && !reader; it = it->next) {
+                    bool used = false;
+                    if (it->used.compare_exchange_strong(used, true)) reader = it;
+                }
+
+                if (!reader) {
+                    reader = new Reader();
+                    reader->next = state.readers.load();
+                    while (!state.readers.compare_exchange_weak(reader->next, reader)) {}
+                }
+
+                reader->depth = 0;
+            }
+
+            ~Registration() {
+                reader->epoch.store(0);
+                reader->used.store(false, std::memory_order_release);
+            }
+        };
+
+        static Reader& m_local() {
+            thread_local Registration registration;
+            return *registration.reader;
+        }
+    };
+
+    /// Destination for formatted records.
+    class Sink;
+
+    /****************
+     *  TIMESTAMPS  *
+     ****************/
+
+    /// Cheap timestamp source for stamping records that are formatted later. Reads the time stamp counter
+    /// where it is invariant, costing a few nanoseconds, and falls back to `std::chrono::steady_clock`
+    /// elsewhere. Ticks are converted to wall clock time with a calibration measured on first use, so the
+    /// cost is paid by whoever formats records rather than whoever logs them. The calibration is measured
+    /// again against the last one every `RECALIBRATION_INTERVAL`, so drift cannot build up over time.
+    class Clock {
+       public:
+        /// Pairing of ticks with wall clock time, and the rate between them.
+        struct Calibration {
+            uint64_t ticks;
+            int64_t wallNanos;
+            int64_t steadyNanos;
+            double nanosPerTick;
+
+            /// Wall clock time of a tick count.
+            std::chrono::system_clock::time_point toWall(uint64_t at) const {
+                const int64_t nanos = wallNanos + static_cast<int64_t>(static_cast<double>(static_cast<int64_t>(at - ticks)) * nanosPerTick);
+                return std::chrono::system_clock::time_point(std::chrono::duration_cast<std::chrono::system_clock::duration>(std::chrono::nanoseconds(nanos)));
+            }
+        };
+
+        /// Current tick count.
+        static uint64_t now() {
+#if defined(TINY_LOGGER_TSC)
+            static const bool invariant = m_invariant();
+            if (invariant) return __rdtsc();
+#endif
+            return static_cast<uint64_t>(m_steadyNanos());
+        }
+
+        /// Calibration in use, measured on first call and again once it is due. Call early to keep the
+        /// first measurement off later paths.
+        static Calibration calibrate() {
+            Rcu::Guard guard;
+            const Calibration* current = m_current().load();
+            if (static_cast<double>(now() - current->ticks) * current->nanosPerTick >= static_cast<double>(std::chrono::nanoseconds(RECALIBRATION_INTERVAL).count())) {
+                m_recalibrate(current);
+                current = m_current().load();
+            }
+            return *current;
+        }
+
+        /// Wall clock time of a tick count.
+        static std::chrono::system_clock::time_point toWall(uint64_t ticks) { return calibrate().toWall(ticks); }
+
+       private:
+        /// Length of time ticks are first measured against the clocks for.
+        static constexpr std::chrono::milliseconds CALIBRATION_PERIOD{10};
+
+        /// Time after which the calibration is measured again.
+        static constexpr std::chrono::seconds RECALIBRATION_INTERVAL{1};
+
+        /// Tries at sampling the clocks, keeping the one where they were read closest together.
+        static constexpr int SAMPLE_TRIES = 5;
+
+        static int64_t m_steadyNanos() { return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count(); }
+
+        static int64_t m_wallNanos() { return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::system_clock::now().time_since_epoch()).count(); }
+
+#if defined(TINY_LOGGER_TSC)
+        /// Whether the time stamp counter runs at a constant rate across power states and cores.
+        static bool m_invariant() {
+            unsigned eax, ebx, ecx, edx;
+            if (!__get_cpuid(0x80000000, &eax, &ebx, &ecx, &edx) || eax < 0x80000007) return false;
+            __get_cpuid(0x80000007, &eax, &ebx, &ecx, &edx);
+            return edx & (1u << 8);
+        }
+#endif
+
+        /// Published calibration, measured on first use.
+        static std::atomic<const Calibration*>& m_current() {
+            static std::atomic<const Calibration*> current{new Calibration(m_measure())};
+            return current;
+        }
+
+        /**
+         * Reads the ticks with the steady clock read either side, keeping the closest pair and pairing the
+         * ticks with their midpoint, then reads the wall clock.
+         * @param since                         Earlier sample to measure the rate from, if any.
+         */
+        static Calibration m_sample(const Calibration* since) {
+            Calibration sample{};
+            int64_t best = INT64_MAX;
+            for (int ii = 0; ii < SAMPLE_TRIES; ii++) {
+                const int64_t before = m_steadyNanos();
+                const uint64_t ticks = now();
+                const int64_t after = m_steadyNanos();
+                if (after - before >= best) continue;
+
+                best = after - before;
+                sample.ticks = ticks;
+                sample.steadyNanos = before + best / 2;
+            }
+            sample.wallNanos = m_wallNanos();
+
+            sample.nanosPerTick = since && sample.ticks != since->ticks ? static_cast<double>(sample.steadyNanos - since->steadyNanos) / static_cast<double>(sample.ticks - since->ticks) : 1.0;
+            return sample;
+        }
+
+        /// Samples the clocks at either end of the calibration period.
+        static Calibration m_measure() {
+            // the first read checks whether the counter can be used at all, which must not be timed
+            now();
+
+            const Calibration start = m_sample(nullptr);
+            while (m_steadyNanos() - start.steadyNanos < std::chrono::nanoseconds(CALIBRATION_PERIOD).count()) std::this_thread::yield();
+            return m_sample(&start);
+        }
+
+        /// Measures the rate since the given calibration and publishes it, from one thread at a time.
+        static void m_recalibrate(const Calibration* previous) {
+            static std::mutex lock;
+            std::unique_lock<std::mutex> guard(lock, std::try_to_lock);
+            if (!guard || m_current().load() != previous) return;
+            Rcu::publish(m_current(), static_cast<const Calibration*>(new Calibration(m_sample(previous))));
+        }
+    };
+
+    /// Local wall clock timestamps, formatted as "YYYY-MM-DD HH:MM:SS.uuuuuu". Everything up to the
+    /// second is cached per thread and only rendered again once the second changes, and the offset from
+    /// UTC is cached process-wide for a quarter of an hour at a time, so `localtime_r` and the lock it
+    /// takes are almost never reached.
+    class Timestamp {
+       public:
+        /// Length of a formatted timestamp.
+        static constexpr size_t SIZE = 26;
+
+        /**
+         * Formats a point in time.
+         * @param out                           Buffer of at least `SIZE` characters.
+         * @param when                          Time to format.
+         * @param signalSafe                    Skips the thread cache and uses the offset as last cached.
+         */
+        static void format(char* out, std::chrono::system_clock::time_point when, bool signalSafe = false) {
+            const int64_t micros = std::chrono::duration_cast<std::chrono::microseconds>(when.time_since_epoch()).count();
+            int64_t secs = micros / 1000000;
+            int64_t frac = micros % 1000000;
+            if (frac < 0) frac += 1000000, secs--;
+
+            if (signalSafe) m_render(out, secs + m_offset(secs, false));
+            else {
+                struct Cache {
+                    int64_t second;
+                    char text[PREFIX_SIZE];
+                };
+
+                thread_local Cache cache{INT64_MIN, {}};
+                if (cache.second != secs) {
+                    m_render(cache.text, secs + m_offset(secs, true));
+                    cache.second = secs;
+                }
+                std::memcpy(out, cache.text, PREFIX_SIZE);
+            }
+
+            out[PREFIX_SIZE] = '.';
+            m_digits(out + PREFIX_SIZE + 1, static_cast<unsigned>(frac), 6);
+        }
+
+       private:
+        /// Length of the part rendered once per second.
+        static constexpr size_t PREFIX_SIZE = 19;
+
+        /// Length of time the offset from UTC is trusted for, as it only changes on the quarter hour.
+        static constexpr int64_t OFFSET_PERIOD = 900;
+
+        /**
+         * Offset of local time from UTC, in seconds.
+         * @param secs                          Seconds since the epoch.
+         * @param refresh                       Whether a stale offset may be looked up again.
+         */
+        static int64_t m_offset(int64_t secs, bool refresh) {
+            // the period and offset are packed together so they are always read as a pair
+            static std::atomic<uint64_t> cached{0};
+            const uint64_t period = static_cast<uint64_t>(secs / OFFSET_PERIOD);
+            uint64_t packed = cached.load(std::memory_order_relaxed);
+            if ((packed >> 32) != period && refresh) {
+                const std::time_t time = static_cast<std::time_t>(secs);
+#if defined(__unix__)
+                std::tm local;
+                localtime_r(&time, &local);
+                const int64_t offset = local.tm_gmtoff;
+#else
+                std::tm utc = *std::gmtime(&time);
+                utc.tm_isdst = -1;
+                const int64_t offset = static_cast<int64_t>(time - std::mktime(&utc));
+#endif
+                packed = (period << 32) | static_cast<uint32_t>(static_cast<int32_t>(offset));
+                cached.store(packed, std::memory_order_relaxed);
+            }
+            return static_cast<int32_t>(static_cast<uint32_t>(packed));
+        }
+
+        /**
+         * Renders the date and time of day, up to the second.
+         * @param out                           Buffer of at least `PREFIX_SIZE` characters.
+         * @param secs                          Local seconds since the epoch.
+         */
+        static void m_render(char* out, int64_t secs) {
+            int64_t days = secs / 86400;
+            int64_t rem = secs % 86400;
+            if (rem < 0) rem += 86400, days--;
+
+            // civil date from days since the epoch, over 400 year eras
+            days += 719468;
+            const int64_t era = (days >= 0 ? days : days - 146096) / 146097;
+            const unsigned doe = static_cast<unsigned>(days - era * 146097);
+            const unsigned yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+            const unsigned doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+            const unsigned mp = (5 * doy + 2) / 153;
+            const unsigned day = doy - (153 * mp + 2) / 5 + 1;
+            const unsigned month = mp < 10 ? mp + 3 : mp - 9;
+            const int64_t year = static_cast<int64_t>(yoe) + era * 400 + (month <= 2);
+
+            m_digits(out, static_cast<unsigned>(year), 4);
+            out[4] = '-';
+            m_digits(out + 5, month, 2);
+            out[7] = '-';
+            m_digits(out + 8, day, 2);
+            out[10] = ' ';
+            m_digits(out + 11, static_cast<unsigned>(rem / 3600), 2);
+            out[13] = ':';
+            m_digits(out + 14, static_cast<unsigned>(rem / 60 % 60), 2);
+            out[16] = ':';
+            m_digits(out + 17, static_cast<unsigned>(rem % 60), 2);
+        }
+
+        /// Writes a zero padded number of a fixed width.
+        static void m_digits(char* out, unsigned value, size_t width) {
+            for (size_t ii = width; ii > 0; ii--, value /= 10) out[ii - 1] = static_cast<char>('0' + value % 10);
+        }
+    };
+
+    /*************
+     *  THREADS  *
+     *************/
+
+    /// Identity of the calling thread, for the `{tid}` and `{thread}` prompt tokens. Both are
+    /// formatted once per thread into fixed thread-local storage, so filling them in is a copy, and
+    /// reading them needs no allocation and is safe from a signal handler.
+    class Thread {
+       public:
+        /// Longest name kept for a thread.
+        static constexpr size_t MAX_NAME_SIZE = 63;
+
+        /// Id of the calling thread, as the OS knows it where possible.
+        static std::string_view id() {
+            Local& local = m_local();
+            if (local.idSize == 0) m_identify(local);
+            return std::string_view(local.id, local.idSize);
+        }
+
+        /// Name of the calling thread, or its id if it has not been named.
+        static std::string_view name() {
+            const Local& local = m_local();
+            return local.nameSize == 0 ? id() : std::string_view(local.name, local.nameSize);
+        }
+
+        /**
+         * Names the calling thread, cutting the name short if it is too long. On Linux, the name is
+         * also given to the OS, where it is shown by debuggers and `top`, and cut to 15 characters.
+         * @param name                          Thread name.
+         */
+        static void setName(std::string_view name) {
+            Local& local = m_local();
+            local.nameSize = std::min(name.size(), MAX_NAME_SIZE);
+            std::memcpy(local.name, name.data(), local.nameSize);
+
+#if defined(__linux__)
+            char os[16] = {};
+            std::memcpy(os, name.data(), std::min(name.size(), sizeof(os) - 1));
+            pthread_setname_np(pthread_self(), os);
+#endif
+        }
+
+       private:
+        struct Local {
+            char id[24];
+            size_t idSize;
+            char name[MAX_NAME_SIZE];
+            size_t nameSize;
+        };
+
+        /// Thread-local identity, zeroed without any dynamic initialisation.
+        static Local& m_local() {
+            thread_local Local local{};
+            return local;
+        }
+
+        /// Formats the id of the calling thread.
+        static void m_identify(Local& local) {
+#if defined(__linux__)
+            const auto id = static_cast<unsigned long long>(::syscall(SYS_gettid));
+#else
+            const auto id = static_cast<unsigned long long>(std::hash<std::thread::id>()(std::this_thread::get_id()));
+#endif
+            const auto res = std::to_chars(local.id, local.id + sizeof(local.id), id);
+            local.idSize = static_cast<size_t>(res.ptr - local.id);
+        }
+    };
+
+    /*********************
+     *  SOURCE LOCATION  *
+     *********************/
+
+    /// Where a record was logged from. Filled in by the `TL_*` macros from string literals, so
+    /// holding one costs nothing and the strings never need copying.
+    struct Location {
+        std::string_view file;
+        unsigned line;
+        std::string_view func;
+
+        /**
+         * Offset of the file name within a path. Used in a constant expression by the macros, so the
+         * directory is stripped at compile time.
+         * @param path                          Path to the source file.
+         */
+        static constexpr size_t basename(const char* path) {
+            size_t offset = 0;
+            for (size_t ii = 0; path[ii] != '\0'; ii++)
+                if (path[ii] == '/' || path[ii] == '\\') offset = ii + 1;
+            return offset;
+        }
+    };
+
     /*****************
      *  CORE LOGGER  *
      *****************/
@@ -27,30 +635,143 @@ namespace tiny {
 
         /// Logger Options.
         struct Options {
+            /// Text leading each record. `{sev}` is replaced with the severity, `{time}` with the local time,
+            /// `{file}`, `{line}` and `{func}` with where the record was logged from by the `TL_*` macros, and
+            /// `{tid}` and `{thread}` with the id and name of the logging thread.
             std::string prompt = "";
             char formatChar = '@';
-        };
 
-        /****************
-         *  PROPERTIES  *
-         ****************/
+            /// Collapses consecutive identical records into a "last message repeated N times" line.
+            bool deduplicate = false;
+
+            /// Longest a run of repeats is held back before its count is written out.
+            std::chrono::milliseconds repeatInterval{1000};
+
+            /// Least severe records that are written out. Named loggers without a threshold inherit that of
+            /// their parent, and any other logger without one writes out everything.
+            std::optional<Severity> threshold = std::nullopt;
+
+            /// Number of records below the threshold kept per thread, and written out ahead of the next
+            /// ERROR or FATAL on that thread. Zero drops them instead.
+            size_t backtrace = 0;
+
+            /// Destinations every record is written to. Records go to `std::cout` when empty.
+            std::vector<std::shared_ptr<Sink>> sinks = {};
 
-        /// Instanced Logger Options.
-        Options options = {"", '@'};
+            /// Destinations for records of particular severities, indexed by severity, used in place of
+            /// `sinks` for any severity given some. Lets errors go straight to an unbuffered stream while
+            /// everything else goes through a large buffer.
+            std::array<std::vector<std::shared_ptr<Sink>>, 5> routes = {};
+
+            /// Least severe records that are flushed as soon as they are written. Anything less severe is
+            /// left to the sinks' own buffering until the next flush.
+            Severity flushOn = TRACE;
+
+            /// Least severe records whose caller waits until they are on stable storage, with `Sink::sync`.
+            /// None by default.
+            std::optional<Severity> syncOn = std::nullopt;
+
+            /// Whether severities are colored with ANSI escape codes. When unset, they are colored only if
+            /// `NO_COLOR` is not set and every sink writes to a terminal.
+            std::optional<bool> color = std::nullopt;
+        };
 
         /******************
          *  CONSTRUCTORS  *
          ******************/
 
+        /// Constructs a new instance of a logger with the default options.
+        Logger() : Logger(Options{"", '@'}) {}
+
         /**
          * Constructs a new instance of a logger with the current details.
          * @param opts                      Logger options.
          */
-        static void initialise(const Options& opts = {"", '@'}) {
+        explicit Logger(const Options& opts) : m_options(new Snapshot(opts)) { m_refreshLevel(); }
+
+        /// Writes out any held back repeat count first.
+        ~Logger() {
+            {
+                std::lock_guard<std::mutex> lock(m_dedup.lock);
+                if (m_dedup.pending) {
+                    RepeatFlusher& flusher = m_repeatFlusher();
+                    std::lock_guard<std::mutex> guard(flusher.lock);
+                    flusher.loggers.erase(std::find(flusher.loggers.begin(), flusher.loggers.end(), this));
+                }
+                m_flushRepeats(*m_options.load());
+            }
+            delete m_options.load();
+        }
+
+        Logger(const Logger&) = delete;
+        Logger& operator=(const Logger&) = delete;
+
+        /**
+         * Process-wide logger, used by the helper macros. It is never destroyed, so can still be
+         * logged to while other statics are torn down.
+         */
+        static Logger& global() {
+            static Logger* logger = new Logger();
+            return *logger;
+        }
+
+        /**
+         * Assigns the options of the process-wide logger.
+         * @param opts                      Logger options.
+         */
+        static void initialise(const Options& opts) {
             /// assign the base options
-            m_options = opts;
+            global().configure(opts);
         }
 
+        /// Resets the process-wide logger to the default options.
+        static void initialise() { initialise(Options{"", '@'}); }
+
+        /**
+         * Finds or creates a named logger. Names are dot separated paths such as "net.http", whose parent
+         * is "net", and the top level names are children of the process-wide logger. A newly created
+         * logger starts with a copy of its parent's options, but without a threshold of its own, so
+         * inherits its parent's until given one.
+         * @param name                      Logger name, where the empty name is the process-wide logger.
+         */
+        static Logger& get(std::string_view name);
+
+        /// Names of every named logger created so far, parents before their children.
+        static std::vector<std::string> names();
+
+        /*******************
+         *  CONFIGURATION  *
+         *******************/
+
+        /// Copy of the current logger options.
+        Options options() const {
+            Rcu::Guard guard;
+            return *m_options.load();
+        }
+
+        /**
+         * Replaces the logger options. The new options are published as a whole, so threads logging
+         * at the same time see either the old or the new options and are never blocked.
+         * @param opts                      Logger options.
+         */
+        void configure(const Options& opts);
+
+        /**
+         * Sets or clears the logger threshold. Named loggers left without one follow their parent.
+         * @param sev                       New threshold.
+         */
+        void setLevel(std::optional<Severity> sev);
+
+        /// Logger name, which is empty for the process-wide logger and any unnamed instances.
+        const std::string& name() const { return m_name; }
+
+        /**
+         * Whether records of the given severity are written out. Only ever reads the cached effective
+         * threshold, however deep in the hierarchy the logger is.
+         * @param sev                       Severity to check.
+         */
+        bool enabled(const Severity& sev) const { return sev <= m_level.load(std::memory_order_relaxed); }
+
         /*****************
          *  LOG METHODS  *
          *****************/
@@ -63,16 +784,49 @@ namespace tiny {
          * @param args                          Variable Message Arguments.
          */
         template <typename... Args>
-        static void log(const Severity& sev, const std::string& fmt, Args&&... args) {
-            // begin the logging output
-            std::cout << m_preparePrompt(sev);
+        void log(const Severity& sev, std::string_view fmt, Args&&... args) {
+            log(Location{"", 0, ""}, sev, fmt, std::forward<Args>(args)...);
+        }
+
+        /**
+         * Logs a message along with where it was logged from, for the `{file}`, `{line}` and `{func}`
+         * prompt tokens. Used by the `TL_*` macros.
+         * @param location                      Source location.
+         * @param sev                           Log Severity.
+         * @param fmt                           Message Format.
+         * @param args                          Variable Message Arguments.
+         */
+        template <typename... Args>
+        void log(const Location& location, const Severity& sev, std::string_view fmt, Args&&... args) {
+            // records past the threshold are either kept for a later backtrace or dropped
+            if (!enabled(sev)) {
+                if (!m_capturing.load(std::memory_order_relaxed)) return;
+
+                Rcu::Guard guard;
+                const Snapshot& opts = *m_options.load();
+                if (opts.backtrace > 0) m_capture(opts, location, sev, fmt, args...);
+                return;
+            }
+
+            // the same options are used throughout, even if they are replaced part way
+            Rcu::Guard guard;
+            const Snapshot& opts = *m_options.load();
+
+            // errors are preceded by whatever was kept on this thread leading up to them
+            if (sev <= ERROR && opts.backtrace > 0) m_dumpBacktrace(opts);
+
+            RecordBuffer& record = m_record();
+            record.clear();
+
+            // begin with the prompt, which is left out of the repeat hash
+            m_preparePrompt(opts, record, sev, location);
+            record.mark();
 
             // process all the arguments recursively
-            std::string buffer = fmt;
-            m_processArguments(buffer, std::forward<Args>(args)...);
+            m_processArguments(opts, record, fmt, std::forward<Args>(args)...);
 
-            // complete the logged output by flushing
-            std::cout << std::endl;
+            // and hand the completed record over to be written
+            m_emit(opts, sev, record);
         }
 
         /**
@@ -82,116 +836,3301 @@ namespace tiny {
          * @param args                          Optional additional values to print.
          */
         template <typename T, typename... Args>
-        static void logValue(const T& initial, Args&&... args) {
-            // grab the total number of arguments
-            const size_t len = sizeof...(Args);
+        void logValue(const T& initial, Args&&... args) {
+            Rcu::Guard guard;
+            const Snapshot& opts = *m_options.load();
 
-            // prepare a output string
-            std::string format = "";
-            for (size_t ii = 0; ii < len; ii++) format += "@ ";
-            format += "@";  // cap off
+            RecordBuffer& record = m_record();
+            record.clear();
 
-            // and process the arguments
-            m_processArguments(format, initial, std::forward<Args>(args)...);
-            std::cout << std::endl;
+            // print each of the values separated by a space
+            record.print(initial);
+            ((record.append(" ", 1), record.print(args)), ...);
+
+            // values are never collapsed, but any held back repeats must go out first, and the next record
+            // is no longer consecutive with the last
+            {
+                std::lock_guard<std::mutex> lock(m_dedup.lock);
+                m_flushRepeats(opts);
+                m_dedup.active = false;
+                m_write(opts, INFO, record, false);
+            }
+            m_sync(opts, INFO);
         }
 
-       private:
-        /// Base Logger Severity Strings.
-        static inline std::array<const char*, 5> m_severityStrings = {"\x1b[1;31mFATAL\x1b[0m", "\x1b[31mERROR\x1b[0m", "\x1b[33mWARNING\x1b[0m", "\x1b[34mINFO\x1b[0m", "TRACE"};
+        /**
+         * Writes out the count of any held back repeated records and flushes the output.
+         */
+        void flush();
 
-        /// Core options.
-        static inline Options m_options = {"", '@'};
+        /**
+         * Flushes, then waits until everything logged so far is on stable storage, for sinks able to
+         * tell. Lets callers opt in to durability for records below `syncOn`.
+         */
+        void sync();
 
+#if defined(__unix__)
         /********************
-         *  HELPER METHODS  *
+         *  EMERGENCY PATH  *
          ********************/
 
         /**
-         * Prepares the prompt with a given severity.
-         * @param sev                           Severity to prepare a prompt with.
+         * Async-signal-safe FATAL log, for use inside signal handlers and other places where the
+         * process may be in a broken state. Formats into a stack buffer without allocating or locking,
+         * and writes the line to stderr with a single `write(2)`, as well as to any signal-safe sinks.
+         * Only integers, booleans, characters, strings and pointers (printed in hex) can be formatted,
+         * and lines longer than `EMERGENCY_LINE_SIZE` are cut short.
+         * @param fmt                           Message Format.
+         * @param args                          Variable Message Arguments.
          */
-        static std::string m_preparePrompt(const Severity& sev) {
-            constexpr size_t REPLACE_LEN = 5;
-            constexpr const char* REPLACE_STR = "{sev}";
-
-            // if the prompt is less than size of 5 then ignore
-            if (m_options.prompt.size() < REPLACE_LEN) return m_options.prompt;
+        template <typename... Args>
+        void logSignalSafe(std::string_view fmt, const Args&... args) {
+            logSignalSafe(Location{"", 0, ""}, fmt, args...);
+        }
 
-            // attempt matching the severity
-            const size_t pos = m_options.prompt.find(REPLACE_STR);
+        /**
+         * Async-signal-safe FATAL log, along with where it was logged from.
+         * @param location                      Source location.
+         * @param fmt                           Message Format.
+         * @param args                          Variable Message Arguments.
+         */
+        template <typename... Args>
+        void logSignalSafe(const Location& location, std::string_view fmt, const Args&... args) {
+            // no guard is taken, as claiming a reader record may allocate
+            const Snapshot& opts = *m_options.load();
+            EmergencyBuffer line;
 
-            // if there is not matching string, then return the base prompt
-            if (pos == std::string::npos) return m_options.prompt;
+            m_preparePrompt(opts, line, FATAL, location, std::nullopt, true);
 
-            // prepare a suitable string to replace with
-            std::string temp = m_options.prompt;
+            // substitute arguments for as long as both they and format characters remain
+            (m_formatSignalSafe(opts, line, fmt, args), ...);
+            line.append(fmt);
+            line.terminate();
 
-            // otherwise replace with the desired severity.
-            return temp.replace(pos, REPLACE_LEN, m_severityStrings[sev]);
+            m_writeSignalSafe(opts, line.data, line.len);
         }
 
         /**
-         * Attempts finding the next available format character.
-         * @param buffer                        Current message buffer.
+         * Installs `signalHandler` for the fatal signals (SIGSEGV, SIGBUS, SIGFPE, SIGILL and SIGABRT),
+         * running on an alternate stack so stack overflows are reported too.
          */
-        static std::string m_findNextFormatCharacter(const std::string& buffer) {
-            std::string::size_type pos = buffer.find(m_options.formatChar);
-            if (pos != std::string::npos) return buffer.substr(0, pos);
-            return buffer;
-        }
+        static void installSignalHandlers();
 
         /**
-         * Base argument processing case.
-         * @param buffer                        Final string buffer.
+         * Signal handler logging the fatal signal and faulting address to the process-wide logger, flushing
+         * its sinks on a best effort basis, and then re-raising the signal with the default action.
+         * @param sig                           Signal number.
+         * @param info                          Signal details.
          */
-        static void m_processArguments(std::string& buffer) { std::cout << buffer; }
+        static void signalHandler(int sig, siginfo_t* info, void*);
 
-        /**
-         * Heavy lifter method to process variadic arguments and buffer. Finds the next format character,
-         * replaces this as needed with an argument, otherwise prints the rest of the available buffer.
-         * @param buffer                        Current message buffer.
-         * @param next                          Next variable argument.
-         * @param args                          Other variable arguments.
-         */
-        template <typename T, typename... Args>
-        static void m_processArguments(std::string& buffer, const T& next, Args&&... args) {
-            // process the current buffer format
-            std::string trimmed = m_findNextFormatCharacter(buffer);
+        /// Longest line written by the emergency path.
+        static constexpr size_t EMERGENCY_LINE_SIZE = 1024;
+#endif
 
-            // pre-emptively print the current trimmed string
-            std::cout << trimmed;
+       private:
+        /// Base Logger Severity Strings, plain and colored.
+        static inline std::array<const char*, 5> m_severityNames = {"FATAL", "ERROR", "WARNING", "INFO", "TRACE"};
+        static inline std::array<const char*, 5> m_severityStrings = {"\x1b[1;31mFATAL\x1b[0m", "\x1b[31mERROR\x1b[0m", "\x1b[33mWARNING\x1b[0m", "\x1b[34mINFO\x1b[0m", "TRACE"};
 
-            // if trimmed same size as buffer, then complete
-            if (trimmed.size() == buffer.size()) return;
+        /// Prompt tokens only known once a record is written.
+        enum class Token : uint8_t { NONE, TIME, FILE, LINE, FUNC, TID, THREAD };
 
-            // otherwise print the current argument
-            std::cout << next;
-            buffer = buffer.substr(trimmed.size() + 1);
+        /// Prompt tokens, besides `{sev}`, which is known ahead of time.
+        static inline std::array<std::pair<std::string_view, Token>, 6> m_tokens = {{{"{time}", Token::TIME}, {"{file}", Token::FILE}, {"{line}", Token::LINE}, {"{func}", Token::FUNC}, {"{tid}", Token::TID}, {"{thread}", Token::THREAD}}};
 
-            // and continue to next argument
-            m_processArguments(buffer, std::forward<Args>(args)...);
-        }
-    };
+        /// Literal prompt text, followed by a token to fill in.
+        struct Segment {
+            std::string text;
+            Token token;
+        };
 
-    /*******************
-     *  CORE LOGGABLE  *
-     *******************/
+        /// Options as published, along with everything worked out from them ahead of time.
+        struct Snapshot : Options {
+            /// Prompts compiled into segments with the severity filled in, plain then colored, indexed by severity.
+            std::array<std::array<std::vector<Segment>, 5>, 2> prompts;
 
-    /// Helper Loggable Abstract Class. Aids in making
-    /// derived classes be loggable.
-    class Loggable {
-       public:
-        /// Make a pure virtual class.
-        virtual ~Loggable() = default;
+            /// Whether the colored prompts are in use.
+            bool colored = false;
 
-        /// Virtualized stringification method.
-        virtual std::string toString() const = 0;
+            explicit Snapshot(const Options& opts);
+        };
 
-        /**
-         * Use the friend keyword to modify the core output stream operator for
-         * simple printing of derived classes.
-         * @param os                                Base Output Stream.
+        /// Core options, published as an immutable snapshot.
+        std::atomic<const Snapshot*> m_options;
+
+        /// Whether records past the threshold are captured for backtraces, cached alongside the level.
+        std::atomic<bool> m_capturing{false};
+
+        /// Effective threshold, cached from the hierarchy whenever it changes.
+        std::atomic<int> m_level{TRACE};
+
+        /// Position in the named logger hierarchy.
+        std::string m_name;
+        Logger* m_parent = nullptr;
+        std::vector<Logger*> m_children;
+
+        /// Unique logger identifier, keying its per-thread state, and a token threads see expire once
+        /// the logger is destroyed, so they free that state.
+        static inline std::atomic<uint64_t> m_nextId{1};
+        const uint64_t m_id = m_nextId.fetch_add(1, std::memory_order_relaxed);
+        const std::shared_ptr<void> m_alive = std::make_shared<char>();
+
+        /// State of the repeated record collapsing stage.
+        struct Dedup {
+            std::mutex lock;
+            bool active = false;
+            Severity severity = TRACE;
+            uint64_t hash = 0;
+            size_t length = 0;
+            size_t repeats = 0;
+            bool pending = false;
+            std::chrono::steady_clock::time_point since;
+        };
+
+        Dedup m_dedup;
+
+        /// Loggers holding back repeats, whose counts a background thread writes out once their repeat
+        /// interval is up, and every one of them at exit. The thread only ever tries the dedup locks, so
+        /// loggers may take the flusher lock while holding theirs.
+        struct RepeatFlusher {
+            std::mutex lock;
+            std::condition_variable wake;
+            std::vector<Logger*> loggers;
+            bool started = false;
+        };
+
+        static RepeatFlusher& m_repeatFlusher() {
+            static RepeatFlusher* flusher = new RepeatFlusher();
+            return *flusher;
+        }
+
+        /// Size of a single backtrace entry, which holds a format and its arguments.
+        static constexpr size_t BACKTRACE_ENTRY_SIZE = 256;
+
+        /// Type tags for arguments captured into a backtrace entry.
+        enum class ArgumentType : uint8_t { SIGNED, UNSIGNED, FLOAT, BOOL, CHAR, STRING };
+
+        /// Ring of records captured below the threshold on a thread, stored unformatted.
+        struct Backtrace {
+            struct Entry {
+                Severity severity;
+                Location location;
+                uint64_t stamp;
+                size_t size;
+                std::array<char, BACKTRACE_ENTRY_SIZE> data;
+            };
+
+            std::vector<Entry> entries;
+            size_t next = 0;
+            size_t count = 0;
+        };
+
+        /// Bounded writer into a backtrace entry.
+        struct EntryWriter {
+            char* pos;
+            char* end;
+
+            bool put(const void* src, size_t len) {
+                if (static_cast<size_t>(end - pos) < len) return false;
+                std::memcpy(pos, src, len);
+                pos += len;
+                return true;
+            }
+
+            template <typename V>
+            bool put(ArgumentType type, const V& value) {
+                if (static_cast<size_t>(end - pos) < 1 + sizeof(V)) return false;
+                return put(&type, 1) && put(&value, sizeof(V));
+            }
+
+            /// Strings too long for the remaining space are cut short.
+            bool putString(ArgumentType type, std::string_view str) {
+                const size_t room = static_cast<size_t>(end - pos);
+                if (room <= 1 + sizeof(uint16_t)) return false;
+                const uint16_t len = static_cast<uint16_t>(std::min(str.size(), room - 1 - sizeof(uint16_t)));
+                return put(&type, 1) && put(&len, sizeof(len)) && put(str.data(), len);
+            }
+        };
+
+        /********************
+         *  HELPER METHODS  *
+         ********************/
+
+        /**
+         * Appends the prompt for a given severity, filling in its tokens.
+         * @param opts                          Options snapshot in use.
+         * @param out                           Buffer to append to.
+         * @param sev                           Severity to prepare a prompt with.
+         * @param location                      Source location of the record.
+         * @param stamp                         Clock ticks the record was stamped with, if not now.
+         * @param signalSafe                    Whether tokens must be filled in async-signal-safely.
+         */
+        template <typename Buffer>
+        static void m_preparePrompt(const Snapshot& opts, Buffer& out, const Severity& sev, const Location& location, std::optional<uint64_t> stamp = std::nullopt, bool signalSafe = false) {
+            for (const Segment& segment : opts.prompts[opts.colored][sev]) {
+                out.append(segment.text.data(), segment.text.size());
+                switch (segment.token) {
+                    case Token::NONE:
+                        break;
+                    case Token::TIME: {
+                        char time[Timestamp::SIZE];
+                        Timestamp::format(time, stamp ? Clock::toWall(*stamp) : std::chrono::system_clock::now(), signalSafe);
+                        out.append(time, sizeof(time));
+                        break;
+                    }
+                    case Token::FILE:
+                        out.append(location.file.data(), location.file.size());
+                        break;
+                    case Token::LINE: {
+                        // unknown lines are left blank rather than shown as zero
+                        char digits[16];
+                        const auto res = std::to_chars(digits, digits + sizeof(digits), location.line);
+                        if (location.line != 0) out.append(digits, static_cast<size_t>(res.ptr - digits));
+                        break;
+                    }
+                    case Token::FUNC:
+                        out.append(location.func.data(), location.func.size());
+                        break;
+                    case Token::TID: {
+                        const std::string_view id = Thread::id();
+                        out.append(id.data(), id.size());
+                        break;
+                    }
+                    case Token::THREAD: {
+                        const std::string_view name = Thread::name();
+                        out.append(name.data(), name.size());
+                        break;
+                    }
+                }
+            }
+        }
+
+        /**
+         * Compiles the prompt into segments split at each token, with the severity filled in.
+         * @param prompt                        Prompt, possibly holding `{sev}` and other tokens.
+         * @param name                          Severity name to fill in.
+         */
+        static std::vector<Segment> m_compilePrompt(std::string_view prompt, const char* name) {
+            std::vector<Segment> segments(1, Segment{"", Token::NONE});
+            while (!prompt.empty()) {
+                if (prompt.substr(0, 5) == "{sev}") {
+                    segments.back().text.append(name);
+                    prompt.remove_prefix(5);
+                    continue;
+                }
+
+                const auto token = std::find_if(m_tokens.begin(), m_tokens.end(), [prompt](const auto& token) { return prompt.substr(0, token.first.size()) == token.first; });
+                if (token == m_tokens.end()) {
+                    segments.back().text.push_back(prompt.front());
+                    prompt.remove_prefix(1);
+                } else {
+                    segments.back().token = token->second;
+                    segments.push_back(Segment{"", Token::NONE});
+                    prompt.remove_prefix(token->first.size());
+                }
+            }
+
+            // a prompt ending in a token leaves nothing after it
+            if (segments.size() > 1 && segments.back().text.empty()) segments.pop_back();
+            return segments;
+        }
+
+        /// Whether colored output has been ruled out for the whole process, detected once.
+        static bool m_noColor() {
+            static const bool noColor = std::getenv("NO_COLOR") != nullptr && *std::getenv("NO_COLOR") != '\0';
+            return noColor;
+        }
+
+        /// Named logger registry, which also guards every logger's place in the hierarchy.
+        struct Registry {
+            std::mutex lock;
+            std::map<std::string, std::unique_ptr<Logger>, std::less<>> loggers;
+        };
+
+        static Registry& m_registry() {
+            static Registry* registry = new Registry();
+            return *registry;
+        }
+
+        /**
+         * Recomputes the cached effective threshold of this logger and everything below it. Expects
+         * the registry lock to be held, or the logger to not be in the hierarchy yet.
+         */
+        void m_refreshLevel() {
+            const Snapshot& opts = *m_options.load();
+            const int level = opts.threshold ? *opts.threshold : m_parent ? m_parent->m_level.load(std::memory_order_relaxed) : TRACE;
+            m_level.store(level, std::memory_order_relaxed);
+            m_capturing.store(opts.backtrace > 0, std::memory_order_relaxed);
+            for (Logger* child : m_children) child->m_refreshLevel();
+        }
+
+        /// Record buffer for the calling thread.
+        static RecordBuffer& m_record() {
+            thread_local RecordBuffer record;
+            return record;
+        }
+
+        /// Backtrace ring of this logger for the calling thread.
+        Backtrace& m_backtrace() const {
+            struct Ring {
+                uint64_t id;
+                std::weak_ptr<void> alive;
+                Backtrace backtrace;
+            };
+
+            thread_local std::vector<Ring> rings;
+            for (Ring& ring : rings)
+                if (ring.id == m_id) return ring.backtrace;
+
+            rings.erase(std::remove_if(rings.begin(), rings.end(), [](const Ring& ring) { return ring.alive.expired(); }), rings.end());
+            rings.push_back({m_id, m_alive, Backtrace{}});
+            return rings.back().backtrace;
+        }
+
+        /**
+         * Captures a record below the threshold into the calling thread's backtrace ring. Only
+         * the format and raw argument values are copied; formatting is left until the ring is dumped.
+         * @param opts                          Options snapshot in use.
+         * @param location                      Source location.
+         * @param sev                           Record severity.
+         * @param fmt                           Message format.
+         * @param args                          Message arguments.
+         */
+        template <typename... Args>
+        void m_capture(const Options& opts, const Location& location, const Severity& sev, std::string_view fmt, const Args&... args) {
+            Backtrace& backtrace = m_backtrace();
+            if (backtrace.entries.size() != opts.backtrace) {
+                backtrace.entries.resize(opts.backtrace);
+                backtrace.next = backtrace.count = 0;
+            }
+
+            // claim the next slot, overwriting the oldest once full
+            Backtrace::Entry& entry = backtrace.entries[backtrace.next];
+            backtrace.next = (backtrace.next + 1) % backtrace.entries.size();
+            backtrace.count = std::min(backtrace.count + 1, backtrace.entries.size());
+
+            // the format goes first, then as many arguments as fit
+            EntryWriter out{entry.data.data(), entry.data.data() + entry.data.size()};
+            const uint16_t len = static_cast<uint16_t>(std::min<size_t>(fmt.size(), BACKTRACE_ENTRY_SIZE - sizeof(len)));
+            out.put(&len, sizeof(len));
+            out.put(fmt.data(), len);
+            (void)(m_captureArgument(out, args) && ...);
+
+            entry.severity = sev;
+            entry.location = location;
+            entry.stamp = Clock::now();
+            entry.size = static_cast<size_t>(out.pos - entry.data.data());
+        }
+
+        /**
+         * Captures a single argument into a backtrace entry. Arithmetic values and strings are
+         * copied as is, anything else is streamed to text first.
+         * @param out                           Entry writer.
+         * @param arg                           Argument to capture.
+         */
+        template <typename T>
+        static bool m_captureArgument(EntryWriter& out, const T& arg) {
+            using U = std::decay_t<T>;
+            if constexpr (std::is_same_v<U, bool>) return out.put(ArgumentType::BOOL, arg);
+            else if constexpr (std::is_same_v<U, char> || std::is_same_v<U, signed char> || std::is_same_v<U, unsigned char>) return out.put(ArgumentType::CHAR, static_cast<char>(arg));
+            else if constexpr (std::is_integral_v<U> && std::is_signed_v<U>) return out.put(ArgumentType::SIGNED, static_cast<long long>(arg));
+            else if constexpr (std::is_integral_v<U>) return out.put(ArgumentType::UNSIGNED, static_cast<unsigned long long>(arg));
+            else if constexpr (std::is_floating_point_v<U>) return out.put(ArgumentType::FLOAT, static_cast<double>(arg));
+            else if constexpr (std::is_same_v<T, const char*> || std::is_same_v<T, char*>) return out.putString(ArgumentType::STRING, arg ? std::string_view(arg) : std::string_view());
+            else if constexpr (std::is_convertible_v<const T&, std::string_view>) return out.putString(ArgumentType::STRING, std::string_view(arg));
+            else {
+                RecordBuffer& scratch = m_record();
+                scratch.clear();
+                scratch.stream() << arg;
+                return out.putString(ArgumentType::STRING, std::string_view(scratch.data(), scratch.size()));
+            }
+        }
+
+        /**
+         * Formats and writes out every record held in the calling thread's backtrace ring, oldest
+         * first, and then empties it.
+         * @param opts                          Options snapshot in use.
+         */
+        void m_dumpBacktrace(const Snapshot& opts) {
+            Backtrace& backtrace = m_backtrace();
+            if (backtrace.count == 0) return;
+
+            RecordBuffer& record = m_record();
+            const size_t first = (backtrace.next + backtrace.entries.size() - backtrace.count) % backtrace.entries.size();
+            for (size_t ii = 0; ii < backtrace.count; ii++) {
+                const Backtrace::Entry& entry = backtrace.entries[(first + ii) % backtrace.entries.size()];
+
+                record.clear();
+                m_preparePrompt(opts, record, entry.severity, entry.location, entry.stamp);
+                record.mark();
+                m_formatEntry(opts, record, entry);
+                m_emit(opts, entry.severity, record);
+            }
+
+            backtrace.count = 0;
+        }
+
+        /**
+         * Formats a captured backtrace entry the same way as the original record would have been.
+         * @param opts                          Options snapshot in use.
+         * @param record                        Record being formatted.
+         * @param entry                         Captured entry.
+         */
+        void m_formatEntry(const Options& opts, RecordBuffer& record, const Backtrace::Entry& entry) {
+            const char* pos = entry.data.data();
+            const char* end = pos + entry.size;
+            auto take = [&pos](void* dst, size_t len) {
+                std::memcpy(dst, pos, len);
+                pos += len;
+            };
+
+            uint16_t len;
+            take(&len, sizeof(len));
+            std::string_view fmt(pos, len);
+            pos += len;
+
+            // substitute arguments for as long as both they and format characters remain
+            size_t at;
+            while (pos < end && (at = fmt.find(opts.formatChar)) != std::string_view::npos) {
+                record.append(fmt.substr(0, at));
+                fmt = fmt.substr(at + 1);
+
+                ArgumentType type;
+                take(&type, 1);
+                switch (type) {
+                    case ArgumentType::SIGNED: {
+                        long long value;
+                        take(&value, sizeof(value));
+                        record.print(value);
+                        break;
+                    }
+                    case ArgumentType::UNSIGNED: {
+                        unsigned long long value;
+                        take(&value, sizeof(value));
+                        record.print(value);
+                        break;
+                    }
+                    case ArgumentType::FLOAT: {
+                        double value;
+                        take(&value, sizeof(value));
+                        record.print(value);
+                        break;
+                    }
+                    case ArgumentType::BOOL: {
+                        bool value;
+                        take(&value, sizeof(value));
+                        record.print(value);
+                        break;
+                    }
+                    case ArgumentType::CHAR: {
+                        char value;
+                        take(&value, sizeof(value));
+                        record.append(&value, 1);
+                        break;
+                    }
+                    case ArgumentType::STRING: {
+                        uint16_t size;
+                        take(&size, sizeof(size));
+                        record.append(pos, size);
+                        pos += size;
+                        break;
+                    }
+                }
+            }
+
+            record.append(fmt);
+        }
+
+        /**
+         * Passes a completed record through the repeat collapsing stage and onto the output.
+         * @param opts                          Options snapshot in use.
+         * @param sev                           Record severity.
+         * @param record                        Formatted record.
+         */
+        void m_emit(const Snapshot& opts, const Severity& sev, RecordBuffer& record) {
+            if (!opts.deduplicate) return m_write(opts, sev, record);
+
+            // the record goes out under the lock, but waiting for the disk happens after it is released
+            if (m_collapse(opts, sev, record)) m_sync(opts, sev);
+        }
+
+        /**
+         * Collapses a repeat of the last record, or writes out the record without syncing it. Takes the dedup lock.
+         * @param opts                          Options snapshot in use.
+         * @param sev                           Record severity.
+         * @param record                        Formatted record.
+         * @returns                             Whether the record was written out.
+         */
+        bool m_collapse(const Snapshot& opts, const Severity& sev, RecordBuffer& record) {
+            std::lock_guard<std::mutex> guard(m_dedup.lock);
+            const auto now = std::chrono::steady_clock::now();
+            const uint64_t hash = record.hash();
+            const size_t length = record.hashedSize();
+
+            // a repeat of the last record only bumps the count, unless it has been held back long enough
+            if (m_dedup.active && m_dedup.severity == sev && m_dedup.hash == hash && m_dedup.length == length) {
+                m_dedup.repeats++;
+                if (now - m_dedup.since >= opts.repeatInterval) {
+                    m_flushRepeats(opts);
+                    m_dedup.since = now;
+                } else if (!m_dedup.pending) {
+                    m_scheduleRepeats();
+                }
+                return false;
+            }
+
+            // otherwise write out what was held back and start tracking the new record
+            m_flushRepeats(opts);
+            m_write(opts, sev, record, false);
+
+            m_dedup.active = true;
+            m_dedup.severity = sev;
+            m_dedup.hash = hash;
+            m_dedup.length = length;
+            m_dedup.since = now;
+            return true;
+        }
+
+        /// Hands this logger to the repeat flusher, starting its thread on first use. Expects the dedup lock to be held.
+        void m_scheduleRepeats() {
+            RepeatFlusher& flusher = m_repeatFlusher();
+            std::lock_guard<std::mutex> guard(flusher.lock);
+            m_dedup.pending = true;
+            flusher.loggers.push_back(this);
+            flusher.wake.notify_one();
+            if (flusher.started) return;
+
+            flusher.started = true;
+            std::atexit([] {
+                RepeatFlusher& flusher = m_repeatFlusher();
+                std::lock_guard<std::mutex> guard(flusher.lock);
+                m_flushDue(flusher, true);
+            });
+            std::thread([&flusher] {
+                std::unique_lock<std::mutex> lock(flusher.lock);
+                while (true) {
+                    const auto due = m_flushDue(flusher, false);
+                    if (due == std::chrono::steady_clock::time_point::max()) flusher.wake.wait(lock);
+                    else flusher.wake.wait_until(lock, due);
+                }
+            }).detach();
+        }
+
+        /**
+         * Writes out the repeat counts held back longer than their interval, and lets go of loggers with
+         * none left. Loggers in the middle of logging are skipped for now. Expects the flusher lock to be held.
+         * @param flusher                       Repeat flusher.
+         * @param all                           Whether to write out every count, due or not.
+         * @returns                             When the next count is due.
+         */
+        static std::chrono::steady_clock::time_point m_flushDue(RepeatFlusher& flusher, bool all) {
+            const auto now = std::chrono::steady_clock::now();
+            auto next = std::chrono::steady_clock::time_point::max();
+
+            auto& loggers = flusher.loggers;
+            for (size_t ii = 0; ii < loggers.size();) {
+                Logger& logger = *loggers[ii];
+                std::unique_lock<std::mutex> lock(logger.m_dedup.lock, std::try_to_lock);
+                if (!lock) {
+                    next = std::min(next, now + std::chrono::milliseconds(1));
+                    ii++;
+                    continue;
+                }
+
+                Rcu::Guard guard;
+                const Snapshot& opts = *logger.m_options.load();
+                if (logger.m_dedup.repeats > 0) {
+                    const auto due = logger.m_dedup.since + opts.repeatInterval;
+                    if (!all && now < due) {
+                        next = std::min(next, due);
+                        ii++;
+                        continue;
+                    }
+
+                    logger.m_flushRepeats(opts);
+                    logger.m_dedup.since = now;
+                }
+
+                logger.m_dedup.pending = false;
+                loggers[ii] = loggers.back();
+                loggers.pop_back();
+            }
+
+            return next;
+        }
+
+        /**
+         * Writes the "last message repeated" line for any held back repeats. Expects the
+         * dedup lock to be held, so the line is only ever flushed, never synced.
+         * @param opts                          Options snapshot in use.
+         */
+        void m_flushRepeats(const Snapshot& opts) {
+            if (m_dedup.repeats == 0) return;
+
+            std::string line;
+            m_preparePrompt(opts, line, m_dedup.severity, Location{"", 0, ""});
+            line += "last message repeated " + std::to_string(m_dedup.repeats) + " times\n";
+            m_write(opts, m_dedup.severity, line.data(), line.size(), false);
+            m_dedup.repeats = 0;
+        }
+
+        /**
+         * Writes a completed record to the output.
+         * @param opts                          Options snapshot in use.
+         * @param sev                           Record severity.
+         * @param record                        Formatted record.
+         * @param sync                          Whether to sync records at least as severe as `syncOn`,
+         *                                      rather than only flush them.
+         */
+        void m_write(const Options& opts, const Severity& sev, RecordBuffer& record, bool sync = true) {
+            record.append("\n", 1);
+            m_write(opts, sev, record.data(), record.size(), sync);
+        }
+
+        /**
+         * Sinks records of the given severity are written to.
+         * @param opts                          Options snapshot in use.
+         * @param sev                           Record severity.
+         */
+        static const std::vector<std::shared_ptr<Sink>>& m_sinks(const Options& opts, const Severity& sev) { return opts.routes[sev].empty() ? opts.sinks : opts.routes[sev]; }
+
+        /**
+         * Calls the given function on every sink, routed or not. Sinks on several routes are visited more than once.
+         * @param opts                          Options snapshot in use.
+         * @param fn                            Function to call.
+         */
+        template <typename Fn>
+        static void m_forEachSink(const Options& opts, Fn&& fn) {
+            for (const auto& sink : opts.sinks) fn(*sink);
+            for (const auto& route : opts.routes)
+                for (const auto& sink : route) fn(*sink);
+        }
+
+        /**
+         * Writes a completed line to every sink for its severity.
+         * @param opts                          Options snapshot in use.
+         * @param sev                           Line severity.
+         * @param data                          Line, including the trailing newline.
+         * @param len                           Line length.
+         * @param sync                          Whether to sync lines at least as severe as `syncOn`,
+         *                                      rather than only flush them.
+         */
+        void m_write(const Options& opts, const Severity& sev, const char* data, size_t len, bool sync = true) const;
+
+        /**
+         * Syncs every sink for the given severity, when it is at least as severe as `syncOn`. Lets
+         * callers write under a lock and wait for the disk outside it.
+         * @param opts                          Options snapshot in use.
+         * @param sev                           Line severity.
+         */
+        void m_sync(const Options& opts, const Severity& sev) const;
+
+#if defined(__unix__)
+        /// Fixed-size stack buffer for the emergency path, always leaving room for a newline.
+        struct EmergencyBuffer {
+            char data[EMERGENCY_LINE_SIZE];
+            size_t len = 0;
+
+            void append(const char* str, size_t size) {
+                size = std::min(size, sizeof(data) - 1 - len);
+                std::memcpy(data + len, str, size);
+                len += size;
+            }
+
+            void append(std::string_view str) { append(str.data(), str.size()); }
+
+            void appendDecimal(unsigned long long value, bool negative) {
+                char digits[24];
+                size_t at = sizeof(digits);
+                do digits[--at] = static_cast<char>('0' + value % 10);
+                while ((value /= 10) != 0);
+                if (negative) digits[--at] = '-';
+                append(digits + at, sizeof(digits) - at);
+            }
+
+            void appendHex(uintptr_t value) {
+                char digits[2 + 2 * sizeof(value)];
+                size_t at = sizeof(digits);
+                do digits[--at] = "0123456789abcdef"[value & 0xF];
+                while ((value >>= 4) != 0);
+                digits[--at] = 'x';
+                digits[--at] = '0';
+                append(digits + at, sizeof(digits) - at);
+            }
+
+            void terminate() { data[len++] = '\n'; }
+        };
+
+        /**
+         * Emergency path counterpart of `m_processArguments`, handling a single argument.
+         * @param opts                          Options snapshot in use.
+         * @param line                          Line being formatted.
+         * @param fmt                           Remaining message format, advanced past the argument.
+         * @param arg                           Argument to format.
+         */
+        template <typename T>
+        void m_formatSignalSafe(const Options& opts, EmergencyBuffer& line, std::string_view& fmt, const T& arg) {
+            using U = std::decay_t<T>;
+
+            const size_t pos = fmt.find(opts.formatChar);
+            if (pos == std::string_view::npos) return;
+            line.append(fmt.substr(0, pos));
+            fmt = fmt.substr(pos + 1);
+
+            if constexpr (std::is_same_v<U, bool>) line.append(arg ? "1" : "0", 1);
+            else if constexpr (std::is_same_v<U, char>) line.append(&arg, 1);
+            else if constexpr (std::is_integral_v<U> && std::is_signed_v<U>) line.appendDecimal(arg < 0 ? 0ull - static_cast<unsigned long long>(arg) : static_cast<unsigned long long>(arg), arg < 0);
+            else if constexpr (std::is_integral_v<U>) line.appendDecimal(arg, false);
+            else if constexpr (std::is_enum_v<U>) line.appendDecimal(static_cast<unsigned long long>(arg), false);
+            else if constexpr (std::is_same_v<T, const char*> || std::is_same_v<T, char*>) line.append(arg ? std::string_view(arg) : std::string_view());
+            else if constexpr (std::is_convertible_v<const T&, std::string_view>) line.append(std::string_view(arg));
+            else if constexpr (std::is_pointer_v<U>) line.appendHex(reinterpret_cast<uintptr_t>(arg));
+            else static_assert(std::is_void_v<T>, "tiny::Logger::logSignalSafe can only format integers, booleans, characters, strings and pointers");
+        }
+
+        /**
+         * Writes an emergency line to stderr and any signal-safe sinks.
+         * @param opts                          Options snapshot in use.
+         * @param data                          Line, including the trailing newline.
+         * @param len                           Line length.
+         */
+        void m_writeSignalSafe(const Options& opts, const char* data, size_t len) const;
+#endif
+
+        /**
+         * Base argument processing case.
+         * @param opts                          Options snapshot in use.
+         * @param record                        Record being formatted.
+         * @param fmt                           Remaining message format.
+         */
+        void m_processArguments(const Options&, RecordBuffer& record, std::string_view fmt) { record.append(fmt); }
+
+        /**
+         * Heavy lifter method to process variadic arguments and format. Finds the next format character,
+         * replaces this as needed with an argument, otherwise prints the rest of the available format.
+         * @param opts                          Options snapshot in use.
+         * @param record                        Record being formatted.
+         * @param fmt                           Remaining message format.
+         * @param next                          Next variable argument.
+         * @param args                          Other variable arguments.
+         */
+        template <typename T, typename... Args>
+        void m_processArguments(const Options& opts, RecordBuffer& record, std::string_view fmt, const T& next, Args&&... args) {
+            // find the next format character
+            const size_t pos = fmt.find(opts.formatChar);
+
+            // if there is none, then print the rest of the format and complete
+            if (pos == std::string_view::npos) return record.append(fmt);
+
+            // otherwise print the leading format and the current argument
+            record.append(fmt.substr(0, pos));
+            record.print(next);
+
+            // and continue to next argument
+            m_processArguments(opts, record, fmt.substr(pos + 1), std::forward<Args>(args)...);
+        }
+    };
+
+    /*****************
+     *  COMPRESSION  *
+     *****************/
+
+    /// Minimal LZ4 frame compressor. Each call produces a complete, independent frame, so a file of
+    /// concatenated frames stays readable by the standard `lz4` tool up to its last whole frame, no
+    /// matter where writing stopped. Matching is a single greedy pass over a small hash table, trading
+    /// some ratio for speed, which log text barely notices.
+    class Lz4 {
+       public:
+        /**
+         * Appends the given data as one frame.
+         * @param out                           Output to append the frame to.
+         * @param data                          Data to compress.
+         * @param len                           Data length.
+         */
+        static void compress(std::string& out, const char* data, size_t len) {
+            out.append(FRAME_HEADER, sizeof(FRAME_HEADER));
+            for (size_t offset = 0; offset < len; offset += MAX_BLOCK_SIZE) {
+                const size_t size = std::min(MAX_BLOCK_SIZE, len - offset);
+
+                // compress into place after the block size, keeping the original if that is no smaller
+                const size_t at = out.size();
+                out.resize(at + 4 + size + size / 255 + 16);
+                size_t packed = m_compressBlock(data + offset, size, &out[at + 4]);
+                uint32_t word = static_cast<uint32_t>(packed);
+                if (packed >= size) {
+                    std::memcpy(&out[at + 4], data + offset, size);
+                    packed = size;
+                    word = static_cast<uint32_t>(size) | UNCOMPRESSED;
+                }
+                m_store32(&out[at], word);
+                out.resize(at + 4 + packed);
+            }
+            out.append(4, '\0');
+        }
+
+        /**
+         * Decompresses a stream of frames, as written by `compress`, stopping at the first incomplete
+         * or damaged one.
+         * @param is                            Compressed stream.
+         * @param os                            Stream to write the data to.
+         * @returns                             Whether the whole stream was read back.
+         */
+        static bool decompress(std::istream& is, std::ostream& os) {
+            char header[sizeof(FRAME_HEADER)];
+            std::string block, data;
+            while (is.read(header, sizeof(header))) {
+                if (std::memcmp(header, FRAME_HEADER, sizeof(header)) != 0) return false;
+                while (true) {
+                    char word[4];
+                    if (!is.read(word, sizeof(word))) return false;
+                    const uint32_t size = m_load32(word) & ~UNCOMPRESSED;
+                    if (size == 0) break;
+                    if (size > MAX_BLOCK_SIZE) return false;
+
+                    block.resize(size);
+                    if (!is.read(&block[0], size)) return false;
+                    if (m_load32(word) & UNCOMPRESSED) data = block;
+                    else if (!m_decompressBlock(block, data)) return false;
+                    os.write(data.data(), static_cast<std::streamsize>(data.size()));
+                }
+            }
+            return is.gcount() == 0;
+        }
+
+       private:
+        static constexpr size_t MAX_BLOCK_SIZE = 64 * 1024;
+        static constexpr uint32_t UNCOMPRESSED = 0x80000000u;
+        static constexpr size_t HASH_BITS = 12;
+
+        /// Frame magic, then independent blocks of at most 64KiB without checksums, then the descriptor checksum.
+        static constexpr char FRAME_HEADER[7] = {'\x04', '\x22', '\x4D', '\x18', '\x60', '\x40', '\x82'};
+
+        /// Matches may not start in the last 12 bytes of a block, and the last 5 are always literals.
+        static constexpr size_t MATCH_LIMIT = 12;
+        static constexpr size_t LAST_LITERALS = 5;
+
+        static uint32_t m_load32(const char* ptr) {
+            uint32_t word;
+            std::memcpy(&word, ptr, sizeof(word));
+            return word;
+        }
+
+        static void m_store32(char* ptr, uint32_t word) { std::memcpy(ptr, &word, sizeof(word)); }
+
+        /// Writes the remainder of a length past the 4-bit token field.
+        static char* m_storeLength(char* out, size_t len) {
+            for (; len >= 255; len -= 255) *out++ = '\xFF';
+            *out++ = static_cast<char>(len);
+            return out;
+        }
+
+        /// Writes one sequence of literals, optionally followed by a match.
+        static char* m_storeSequence(char* out, const char* literals, size_t count, size_t offset, size_t match) {
+            char* token = out++;
+            *token = static_cast<char>(std::min<size_t>(count, 15) << 4);
+            if (count >= 15) out = m_storeLength(out, count - 15);
+            std::memcpy(out, literals, count);
+            out += count;
+
+            if (match == 0) return out;
+            *out++ = static_cast<char>(offset & 0xFF);
+            *out++ = static_cast<char>(offset >> 8);
+            *token = static_cast<char>(*token | std::min<size_t>(match - 4, 15));
+            if (match - 4 >= 15) out = m_storeLength(out, match - 4 - 15);
+            return out;
+        }
+
+        static size_t m_compressBlock(const char* src, size_t len, char* dst) {
+            uint32_t table[1 << HASH_BITS] = {};
+            char* out = dst;
+            size_t anchor = 0, pos = 0;
+
+            while (len > MATCH_LIMIT && pos < len - MATCH_LIMIT) {
+                // positions are stored off by one, so that zero means empty
+                const uint32_t word = m_load32(src + pos);
+                uint32_t& slot = table[(word * 2654435761u) >> (32 - HASH_BITS)];
+                const size_t candidate = slot;
+                slot = static_cast<uint32_t>(pos + 1);
+
+                if (candidate == 0 || pos + 1 - candidate > 0xFFFF || m_load32(src + candidate - 1) != word) {
+                    // step faster through data that is not matching
+                    pos += 1 + ((pos - anchor) >> 6);
+                    continue;
+                }
+
+                const size_t ref = candidate - 1;
+                size_t end = pos + 4;
+                while (end < len - LAST_LITERALS && src[end] == src[ref + end - pos]) end++;
+
+                out = m_storeSequence(out, src + anchor, pos - anchor, pos - ref, end - pos);
+                anchor = pos = end;
+            }
+
+            out = m_storeSequence(out, src + anchor, len - anchor, 0, 0);
+            return static_cast<size_t>(out - dst);
+        }
+
+        static bool m_decompressBlock(const std::string& block, std::string& out) {
+            out.clear();
+            const unsigned char* in = reinterpret_cast<const unsigned char*>(block.data());
+            const unsigned char* end = in + block.size();
+
+            // reads the remainder of a length, if the token field was saturated
+            auto length = [&](size_t len) {
+                if (len == 15) {
+                    unsigned char byte;
+                    do {
+                        if (in == end) return SIZE_MAX;
+                        len += byte = *in++;
+                    } while (byte == 255);
+                }
+                return len;
+            };
+
+            while (in < end) {
+                const unsigned char token = *in++;
+                const size_t count = length(token >> 4);
+                if (count > static_cast<size_t>(end - in)) return false;
+                out.append(reinterpret_cast<const char*>(in), count);
+                in += count;
+                if (in == end) break;
+
+                if (end - in < 2) return false;
+                const size_t offset = in[0] | (static_cast<size_t>(in[1]) << 8);
+                in += 2;
+                const size_t match = length(token & 0x0F);
+                if (offset == 0 || offset > out.size() || match == SIZE_MAX || out.size() + match + 4 > MAX_BLOCK_SIZE) return false;
+
+                // matches may overlap what they copy, so go byte by byte
+                for (size_t ii = 0, from = out.size() - offset; ii < match + 4; ii++) out.push_back(out[from + ii]);
+            }
+            return out.size() <= MAX_BLOCK_SIZE;
+        }
+    };
+
+    /**********
+     *  SINK  *
+     **********/
+
+    /// Base Sink Class. Receives every completed line, including its trailing newline. Sinks
+    /// may be written to from several threads at once.
+    class Sink {
+       public:
+        /// Make a pure virtual class.
+        virtual ~Sink() = default;
+
+        /**
+         * Writes a completed line.
+         * @param sev                           Line severity.
+         * @param data                          Line, including the trailing newline.
+         * @param len                           Line length.
+         */
+        virtual void write(const Logger::Severity& sev, const char* data, size_t len) = 0;
+
+        /// Flushes anything buffered by the sink.
+        virtual void flush() {}
+
+        /// Flushes, then waits until everything written so far is on stable storage. Sinks that cannot
+        /// tell only flush.
+        virtual void sync() { flush(); }
+
+        /// Whether lines end up on a terminal, and so may be colored.
+        virtual bool terminal() const { return false; }
+
+        /// Whether `write` is async-signal-safe, and so can be used by the emergency path.
+        virtual bool signalSafe() const { return false; }
+
+        /// Best effort attempt at getting buffered lines out, called from the fatal signal handler.
+        /// Must only do async-signal-safe work.
+        virtual void emergencyFlush() {}
+
+        /// Descriptor the emergency path may write lines straight to once `emergencyFlush` has emptied
+        /// the sink's own buffer, or -1 if there is none.
+        virtual int emergencyFd() const { return -1; }
+    };
+
+    /// Sink writing to an output stream.
+    class StreamSink : public Sink {
+       public:
+        /**
+         * Constructs a sink over the given stream, which must outlive it.
+         * @param os                            Output stream.
+         */
+        explicit StreamSink(std::ostream& os) : m_os(os) {}
+
+        void write(const Logger::Severity&, const char* data, size_t len) override {
+            std::lock_guard<std::mutex> guard(m_lock);
+            m_os.write(data, static_cast<std::streamsize>(len));
+        }
+
+        void flush() override {
+            std::lock_guard<std::mutex> guard(m_lock);
+            m_os.flush();
+        }
+
+        /// Only the standard streams are known to go anywhere in particular.
+        bool terminal() const override {
+#if defined(__unix__)
+            if (&m_os == &std::cout) return ::isatty(STDOUT_FILENO);
+            if (&m_os == &std::cerr || &m_os == &std::clog) return ::isatty(STDERR_FILENO);
+#endif
+            return false;
+        }
+
+       private:
+        std::ostream& m_os;
+        std::mutex m_lock;
+    };
+
+#if defined(__unix__)
+    /// Sink writing straight to a file descriptor through a buffer of its own, with none of the
+    /// iostream machinery `StreamSink` goes through. Nothing else should write to the same descriptor
+    /// through a buffer of its own, such as `std::cout`, or lines can be interleaved.
+    class FdSink : public Sink {
+       public:
+        /**
+         * Constructs a sink over the given descriptor, which must outlive it.
+         * @param fd                            Output descriptor.
+         * @param bufferSize                    Bytes buffered before writing.
+         */
+        explicit FdSink(int fd = STDOUT_FILENO, size_t bufferSize = 64 * 1024) : m_fd(fd), m_buffer(new char[bufferSize]), m_bufferSize(bufferSize) {}
+
+        ~FdSink() { flush(); }
+
+        FdSink(const FdSink&) = delete;
+        FdSink& operator=(const FdSink&) = delete;
+
+        void write(const Logger::Severity&, const char* data, size_t len) override {
+            std::lock_guard<std::mutex> guard(m_lock);
+            if (m_used + len > m_bufferSize) m_flushBuffer();
+
+            // lines too long to buffer go straight out
+            if (len > m_bufferSize) return m_writeAll(data, len);
+            std::memcpy(m_buffer.get() + m_used, data, len);
+            m_used += len;
+        }
+
+        void flush() override {
+            std::lock_guard<std::mutex> guard(m_lock);
+            m_flushBuffer();
+        }
+
+        bool terminal() const override { return ::isatty(m_fd); }
+
+        int emergencyFd() const override { return m_fd; }
+
+        /// Writes out whatever is buffered without taking the lock, so a line being added at the time may be cut short.
+        void emergencyFlush() override {
+            const size_t used = m_used;
+            m_writeAll(m_buffer.get(), std::min(used, m_bufferSize));
+            m_used = 0;
+        }
+
+       private:
+        int m_fd;
+        std::unique_ptr<char[]> m_buffer;
+        size_t m_bufferSize;
+        size_t m_used = 0;
+        std::mutex m_lock;
+
+        void m_writeAll(const char* data, size_t len) {
+            while (len > 0) {
+                const ssize_t written = ::write(m_fd, data, len);
+                if (written < 0) {
+                    if (errno == EINTR) continue;
+                    return;
+                }
+                data += written;
+                len -= static_cast<size_t>(written);
+            }
+        }
+
+        /// Writes out the buffer. Expects the lock held.
+        void m_flushBuffer() {
+            m_writeAll(m_buffer.get(), m_used);
+            m_used = 0;
+        }
+    };
+
+    /// Always-on flight recorder. Lines are copied into a fixed-size circular file mapped with
+    /// `MAP_SHARED`, so whatever was written survives the process crashing without a flush, and
+    /// writing never makes a system call. Read the file back with `FlightRecorder::extract`.
+    class FlightRecorder : public Sink {
+       public:
+        /**
+         * Opens or creates a flight recorder file, throwing `std::system_error` if it cannot be mapped
+         * or the capacity is zero. An existing recording of the same capacity is appended to, anything
+         * else is started afresh.
+         * @param path                          Recording file path.
+         * @param capacity                      Bytes of history kept.
+         */
+        FlightRecorder(const std::string& path, size_t capacity) : m_capacity(capacity) {
+            if (capacity == 0) throw std::system_error(EINVAL, std::generic_category(), "tiny::FlightRecorder: zero capacity " + path);
+
+            m_fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+            if (m_fd < 0) throw std::system_error(errno, std::generic_category(), "tiny::FlightRecorder: open " + path);
+
+            const size_t size = sizeof(Header) + capacity;
+            if (::ftruncate(m_fd, static_cast<off_t>(size)) != 0) {
+                const int err = errno;
+                ::close(m_fd);
+                throw std::system_error(err, std::generic_category(), "tiny::FlightRecorder: ftruncate " + path);
+            }
+
+            void* map = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, m_fd, 0);
+            if (map == MAP_FAILED) {
+                const int err = errno;
+                ::close(m_fd);
+                throw std::system_error(err, std::generic_category(), "tiny::FlightRecorder: mmap " + path);
+            }
+
+            m_header = static_cast<Header*>(map);
+            m_data = static_cast<char*>(map) + sizeof(Header);
+
+            // start a new recording unless this is one we can carry on from
+            if (std::memcmp(m_header->magic, MAGIC, sizeof(MAGIC)) != 0 || m_header->capacity != capacity) {
+                m_header->capacity = capacity;
+                m_header->head.store(0, std::memory_order_relaxed);
+                std::memcpy(m_header->magic, MAGIC, sizeof(MAGIC));
+            }
+        }
+
+        ~FlightRecorder() {
+            ::munmap(m_header, sizeof(Header) + m_capacity);
+            ::close(m_fd);
+        }
+
+        FlightRecorder(const FlightRecorder&) = delete;
+        FlightRecorder& operator=(const FlightRecorder&) = delete;
+
+        void write(const Logger::Severity&, const char* data, size_t len) override {
+            // only the tail of a line longer than the whole recording is kept
+            if (len > m_capacity) {
+                data += len - m_capacity;
+                len = m_capacity;
+            }
+
+            // claim a range and copy into it, wrapping around the end
+            const uint64_t at = m_header->head.fetch_add(len, std::memory_order_relaxed);
+            const size_t offset = static_cast<size_t>(at % m_capacity);
+            const size_t first = std::min(len, m_capacity - offset);
+            std::memcpy(m_data + offset, data, first);
+            std::memcpy(m_data, data + first, len - first);
+        }
+
+        bool signalSafe() const override { return true; }
+
+        /**
+         * Reads a recording back, oldest line first. A line partly overwritten by the wrap around
+         * is skipped.
+         * @param path                          Recording file path.
+         * @param os                            Stream to write the recording to.
+         * @returns                             Whether the file held a recording.
+         */
+        static bool extract(const std::string& path, std::ostream& os) {
+            const int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+            if (fd < 0) return false;
+
+            struct stat st;
+            void* map = (::fstat(fd, &st) == 0 && static_cast<size_t>(st.st_size) >= sizeof(Header)) ? ::mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_SHARED, fd, 0) : MAP_FAILED;
+            ::close(fd);
+            if (map == MAP_FAILED) return false;
+
+            const Header* header = static_cast<const Header*>(map);
+            const char* data = static_cast<const char*>(map) + sizeof(Header);
+            const bool valid = std::memcmp(header->magic, MAGIC, sizeof(MAGIC)) == 0 && sizeof(Header) + header->capacity <= static_cast<size_t>(st.st_size);
+
+            if (valid && header->capacity > 0) {
+                const uint64_t head = header->head.load(std::memory_order_relaxed);
+                const size_t capacity = static_cast<size_t>(header->capacity);
+                const size_t used = static_cast<size_t>(std::min<uint64_t>(head, capacity));
+                size_t offset = static_cast<size_t>((head - used) % capacity);
+                size_t remaining = used;
+
+                // once wrapped, the oldest line has likely been cut into, so skip to the next one
+                if (head > capacity) {
+                    while (remaining > 0 && data[offset] != '\n') {
+                        offset = (offset + 1) % capacity;
+                        remaining--;
+                    }
+                    if (remaining > 0) {
+                        offset = (offset + 1) % capacity;
+                        remaining--;
+                    }
+                }
+
+                const size_t first = std::min(remaining, capacity - offset);
+                os.write(data + offset, static_cast<std::streamsize>(first));
+                os.write(data, static_cast<std::streamsize>(remaining - first));
+            }
+
+            ::munmap(map, static_cast<size_t>(st.st_size));
+            return valid;
+        }
+
+       private:
+        static constexpr char MAGIC[8] = {'T', 'L', 'F', 'L', 'I', 'G', 'H', 'T'};
+        static_assert(std::atomic<uint64_t>::is_always_lock_free, "the recording head must be lock free");
+
+        /// Recording header, at the start of the file.
+        struct Header {
+            char magic[8];
+            uint64_t capacity;
+            std::atomic<uint64_t> head;
+        };
+
+        size_t m_capacity;
+        int m_fd = -1;
+        Header* m_header = nullptr;
+        char* m_data = nullptr;
+    };
+
+    /// Buffered file sink, optionally rotating the file by size and/or on a wall-clock interval. The
+    /// current file is always at `path`, and rotated files are renamed to `path.1`, `path.2` and so on,
+    /// newest first. Renaming and deleting happen on a background thread, which also keeps the next
+    /// file open ahead of time, so rotating only ever swaps a descriptor on the writing thread.
+    ///
+    /// When compressing, each filled buffer is handed to the background thread and written as its own
+    /// LZ4 frame (see `Lz4`), so the file can be read back up to the last frame written after a crash.
+    ///
+    /// When durable, `sync` waits for an `fdatasync` covering the caller's lines, which the background
+    /// thread runs on behalf of every thread waiting, so concurrent callers share a single one.
+    ///
+    /// When direct, the file is written with `O_DIRECT` in whole aligned blocks, keeping log volume out
+    /// of the page cache. The partly filled block at the end of the file is padded out to write it, then
+    /// cut back with `ftruncate`, and written again in full by the next flush.
+    class FileSink : public Sink {
+       public:
+        /// File Sink Options.
+        struct Options {
+            std::string path;
+
+            /// Bytes written before rotating. Zero never rotates by size.
+            size_t maxSize = 0;
+
+            /// Wall-clock interval to rotate on, aligned to the epoch (so hourly rotates on the hour).
+            /// Zero never rotates by time.
+            std::chrono::seconds interval{0};
+
+            /// Most rotated files kept. Zero keeps them all.
+            size_t maxFiles = 0;
+
+            /// Most bytes kept across rotated files, deleting the oldest first. Zero keeps them all.
+            size_t maxTotalSize = 0;
+
+            /// Bytes buffered before writing to the file. When compressing, this is also the frame size.
+            size_t bufferSize = 64 * 1024;
+
+            /// Whether to compress the file as a stream of LZ4 frames, off the writing thread. Sizes
+            /// used for rotation and retention are then those of the compressed files.
+            bool compress = false;
+
+            /// Whether `sync` waits for lines to reach the disk, rather than only flushing.
+            bool durable = false;
+
+            /// Whether to bypass the page cache with `O_DIRECT`. Each flush writes at least a whole block, so
+            /// flush rarely. Ignored when compressing, or where the file system does not support it.
+            bool direct = false;
+        };
+
+        /**
+         * Opens the file for appending, throwing `std::system_error` if it cannot be.
+         * @param opts                          File sink options.
+         */
+        explicit FileSink(const Options& opts) : m_opts(opts) {
+            m_direct = m_opts.direct && !m_opts.compress && DIRECT_FLAG != 0;
+            m_fd = m_open(m_opts.path, m_appendFlag());
+            if (m_fd < 0 && m_direct && errno == EINVAL) {
+                m_direct = false;
+                m_fd = m_open(m_opts.path, m_appendFlag());
+            }
+            if (m_fd < 0) throw std::system_error(errno, std::generic_category(), "tiny::FileSink: open " + m_opts.path);
+
+            struct stat st;
+            m_size = ::fstat(m_fd, &st) == 0 ? static_cast<size_t>(st.st_size) : 0;
+            m_buffer.reserve(m_opts.bufferSize);
+            if (m_direct) m_loadTail();
+            m_scheduleRotation();
+
+            if (m_rotates() || m_opts.compress || m_opts.durable) m_thread = std::thread([this] { m_worker(); });
+        }
+
+        ~FileSink() {
+            {
+                std::lock_guard<std::mutex> guard(m_lock);
+                m_flushBuffer();
+                m_stopping = true;
+            }
+
+            m_wake.notify_one();
+            if (m_thread.joinable()) m_thread.join();
+
+            ::close(m_fd);
+            if (m_spare >= 0) {
+                ::close(m_spare);
+                ::unlink(m_sparePath().c_str());
+            }
+        }
+
+        FileSink(const FileSink&) = delete;
+        FileSink& operator=(const FileSink&) = delete;
+
+        void write(const Logger::Severity&, const char* data, size_t len) override {
+            std::unique_lock<std::mutex> lock(m_lock);
+
+            // a due rotation happens before the line, so it lands in the new file
+            if (m_opts.interval.count() > 0 && std::chrono::system_clock::now() >= m_nextRotation) {
+                m_flushBuffer();
+                m_rotate();
+            }
+
+            m_buffer.append(data, len);
+            if (m_buffer.size() < m_opts.bufferSize) return;
+
+            // only let the compressor fall so far behind
+            m_drained.wait(lock, [this] { return m_frames.size() < MAX_PENDING_FRAMES; });
+            m_flushBuffer();
+        }
+
+        /// Writes out the buffer. When compressing, it is only handed to the background thread, so
+        /// flushing often costs little more than the frames it produces.
+        void flush() override {
+            std::lock_guard<std::mutex> guard(m_lock);
+            m_flushBuffer();
+        }
+
+        /// Writes out the buffer and, when durable, waits for the next sync of the file to cover it.
+        void sync() override {
+            std::unique_lock<std::mutex> lock(m_lock);
+            m_flushBuffer();
+            if (!m_opts.durable) return;
+
+            const uint64_t target = m_flushed;
+            m_syncWanted = std::max(m_syncWanted, target);
+            m_wake.notify_one();
+            m_durable.wait(lock, [this, target] { return m_synced >= target; });
+        }
+
+        /// Writes out whatever is buffered without taking the lock, so a line being added at the time may be
+        /// cut short. Compressed and direct files are left alone, as raw or unaligned writes would corrupt or
+        /// fail on them, and frames still waiting for the background thread are lost.
+        void emergencyFlush() override {
+            if (m_opts.compress || m_direct) return;
+            const size_t used = m_buffer.size();
+            m_writeAll(m_fd, m_buffer.data(), std::min(used, m_buffer.capacity()));
+            m_buffer.clear();
+        }
+
+        int emergencyFd() const override { return m_opts.compress || m_direct ? -1 : m_fd; }
+
+       private:
+        static constexpr size_t MAX_PENDING_FRAMES = 4;
+        static constexpr size_t DIRECT_BLOCK = 4096;
+#if defined(O_DIRECT)
+        static constexpr int DIRECT_FLAG = O_DIRECT;
+#else
+        static constexpr int DIRECT_FLAG = 0;
+#endif
+
+        /// Buffer waiting to be compressed, and the file it belongs in.
+        struct Frame {
+            int fd;
+            std::string data;
+        };
+
+        Options m_opts;
+        std::mutex m_lock;
+        std::string m_buffer;
+        int m_fd = -1;
+        size_t m_size = 0;
+        std::chrono::system_clock::time_point m_nextRotation;
+
+        /// Aligned buffer for direct writes, starting with the partly filled block at the end of the file,
+        /// and whether padding is still left past the end after a failed truncate.
+        bool m_direct = false;
+        std::unique_ptr<char, void (*)(void*)> m_staging{nullptr, std::free};
+        size_t m_stagingSize = 0;
+        bool m_padded = false;
+
+        /// Rotation and compression state, shared with the background thread under the lock.
+        std::thread m_thread;
+        std::condition_variable m_wake;
+        std::condition_variable m_drained;
+        std::vector<int> m_retired;
+        std::vector<Frame> m_frames;
+        std::vector<std::string> m_spareBuffers;
+        int m_spare = -1;
+        bool m_stopping = false;
+
+        /// Group commit state, counted in bytes taken out of the buffer. Everything up to `m_written`
+        /// has been written to a file, and everything up to `m_synced` is on the disk.
+        std::condition_variable m_durable;
+        uint64_t m_flushed = 0;
+        uint64_t m_written = 0;
+        uint64_t m_syncWanted = 0;
+        uint64_t m_synced = 0;
+
+        bool m_rotates() const { return m_opts.maxSize > 0 || m_opts.interval.count() > 0; }
+
+        std::string m_sparePath() const { return m_opts.path + ".next"; }
+
+        std::string m_rotatedPath(size_t index) const { return m_opts.path + "." + std::to_string(index); }
+
+        static int m_open(const std::string& path, int flags) { return ::open(path.c_str(), O_WRONLY | O_CREAT | O_CLOEXEC | flags, 0644); }
+
+        /// Direct writes go to explicit offsets, which appending would ignore.
+        int m_appendFlag() const { return m_direct ? DIRECT_FLAG : O_APPEND; }
+
+        void m_scheduleRotation() {
+            if (m_opts.interval.count() <= 0) return;
+            const auto now = std::chrono::system_clock::now().time_since_epoch();
+            m_nextRotation = std::chrono::system_clock::time_point((now / m_opts.interval + 1) * m_opts.interval);
+        }
+
+        /// Writes all of the given data, returning how much made it out.
+        static size_t m_writeAll(int fd, const char* data, size_t len) {
+            size_t done = 0;
+            while (done < len) {
+                const ssize_t written = ::write(fd, data + done, len - done);
+                if (written < 0) {
+                    if (errno == EINTR) continue;
+                    break;
+                }
+                done += static_cast<size_t>(written);
+            }
+            return done;
+        }
+
+        /// Writes out the buffer, or queues it for compression, rotating afterwards if the file has
+        /// grown too big. Expects the lock held.
+        void m_flushBuffer() {
+            m_flushed += m_buffer.size();
+            if (m_opts.compress) {
+                if (m_buffer.empty()) return;
+
+                // while the compressor is busy, small flushes join the last queued frame
+                if (!m_frames.empty() && m_frames.back().fd == m_fd && m_frames.back().data.size() < m_opts.bufferSize) {
+                    m_frames.back().data += m_buffer;
+                    m_buffer.clear();
+                    return;
+                }
+
+                m_frames.push_back({m_fd, std::move(m_buffer)});
+                m_buffer.clear();
+                if (!m_spareBuffers.empty()) {
+                    m_buffer = std::move(m_spareBuffers.back());
+                    m_spareBuffers.pop_back();
+                }
+                m_buffer.reserve(m_opts.bufferSize);
+                m_wake.notify_one();
+                return;
+            }
+
+            if (m_direct) m_writeDirect();
+            else m_size += m_writeAll(m_fd, m_buffer.data(), m_buffer.size());
+            m_written = m_flushed;
+            m_buffer.clear();
+
+            if (m_opts.maxSize > 0 && m_size >= m_opts.maxSize) m_rotate();
+        }
+
+        /// Grows the staging buffer to at least the given size, keeping the partly filled block at its front.
+        void m_reserveStaging(size_t size) {
+            if (size <= m_stagingSize) return;
+            size = (size + DIRECT_BLOCK - 1) / DIRECT_BLOCK * DIRECT_BLOCK;
+
+            std::unique_ptr<char, void (*)(void*)> staging(static_cast<char*>(std::aligned_alloc(DIRECT_BLOCK, size)), std::free);
+            if (!staging) throw std::bad_alloc();
+            if (m_staging) std::memcpy(staging.get(), m_staging.get(), DIRECT_BLOCK);
+            m_staging = std::move(staging);
+            m_stagingSize = size;
+        }
+
+        /// Reads back the partly filled block at the end of an existing file, to be written again.
+        void m_loadTail() {
+            m_reserveStaging(m_opts.bufferSize + DIRECT_BLOCK);
+            const size_t head = m_size % DIRECT_BLOCK;
+            if (head == 0) return;
+
+            const int fd = ::open(m_opts.path.c_str(), O_RDONLY | O_CLOEXEC);
+            const bool loaded = fd >= 0 && ::pread(fd, m_staging.get(), head, static_cast<off_t>(m_size - head)) == static_cast<ssize_t>(head);
+            if (fd >= 0) ::close(fd);
+
+            // without it, carry on from the next whole block rather than overwrite what is there
+            if (!loaded) m_size += DIRECT_BLOCK - head;
+        }
+
+        /// Writes out the buffer in whole aligned blocks, from the start of the partly filled block at the
+        /// end of the file, then cuts off the padding. Expects the lock held.
+        void m_writeDirect() {
+            if (m_padded) m_truncate();
+            if (m_buffer.empty()) return;
+
+            const size_t head = m_size % DIRECT_BLOCK;
+            const size_t total = head + m_buffer.size();
+            const size_t padded = (total + DIRECT_BLOCK - 1) / DIRECT_BLOCK * DIRECT_BLOCK;
+            m_reserveStaging(padded);
+
+            char* staging = m_staging.get();
+            std::memcpy(staging + head, m_buffer.data(), m_buffer.size());
+            std::memset(staging + total, 0, padded - total);
+
+            const size_t at = m_size - head;
+            for (size_t done = 0; done < padded;) {
+                const ssize_t written = ::pwrite(m_fd, staging + done, padded - done, static_cast<off_t>(at + done));
+                if (written < 0 && errno == EINTR) continue;
+                if (written <= 0) break;
+                done += static_cast<size_t>(written);
+            }
+
+            const size_t tail = total % DIRECT_BLOCK;
+            m_size = at + total;
+            m_padded = tail != 0;
+            if (m_padded) m_truncate();
+
+            // the new partly filled block moves to the front, ready for next time
+            std::memmove(staging, staging + total - tail, tail);
+        }
+
+        /// Cuts the padding after the last direct write off the file. On failure it is left for the next
+        /// flush to try again, rather than leaving zeros the file would be reopened after. Expects the lock held.
+        void m_truncate() {
+            int res;
+            while ((res = ::ftruncate(m_fd, static_cast<off_t>(m_size))) != 0 && errno == EINTR) {}
+            m_padded = res != 0;
+        }
+
+        /// Swaps over to the spare file and hands the old one to the background thread. When the spare
+        /// is not ready yet, the current file is kept and rotation is tried again later. Expects the lock held.
+        void m_rotate() {
+            if (m_spare < 0) return;
+            if (m_padded) m_truncate();
+            m_padded = false;
+
+            m_retired.push_back(m_fd);
+            m_fd = m_spare;
+            m_spare = -1;
+            m_size = 0;
+            m_scheduleRotation();
+            m_wake.notify_one();
+        }
+
+        /// Background thread, compressing queued buffers, renaming and pruning rotated files, opening
+        /// the next spare and syncing the file for threads waiting on it.
+        void m_worker() {
+            std::string packed;
+            std::unique_lock<std::mutex> lock(m_lock);
+            while (true) {
+                // keep a spare ready for the next rotation, once the last one has been moved into place
+                if (m_rotates() && m_spare < 0 && m_retired.empty() && !m_stopping) {
+                    lock.unlock();
+                    const int spare = m_open(m_sparePath(), m_appendFlag() | O_TRUNC);
+                    lock.lock();
+                    m_spare = spare;
+                }
+
+                m_wake.wait(lock, [this] { return m_stopping || !m_retired.empty() || !m_frames.empty() || m_syncWanted > m_synced; });
+                if (m_retired.empty() && m_frames.empty() && m_syncWanted <= m_synced) return;
+
+                // frames are queued before the file they belong in is retired, so write them first
+                std::vector<Frame> frames = std::move(m_frames);
+                const std::vector<int> retired = std::move(m_retired);
+                m_frames.clear();
+                m_retired.clear();
+                lock.unlock();
+
+                for (Frame& frame : frames) {
+                    packed.clear();
+                    Lz4::compress(packed, frame.data.data(), frame.data.size());
+                    const size_t written = m_writeAll(frame.fd, packed.data(), packed.size());
+
+                    lock.lock();
+                    m_written += frame.data.size();
+                    frame.data.clear();
+                    m_spareBuffers.push_back(std::move(frame.data));
+                    if (frame.fd == m_fd) {
+                        m_size += written;
+                        if (m_opts.maxSize > 0 && m_size >= m_opts.maxSize) m_rotate();
+                    }
+                    m_drained.notify_all();
+                    lock.unlock();
+                }
+
+                for (int fd : retired) {
+                    if (m_opts.durable) ::fdatasync(fd);
+                    ::close(fd);
+                    m_shift();
+                }
+
+                lock.lock();
+
+                // one sync covers every waiter so far, as long as nothing written is still in a retired
+                // file, and while it runs the next waiters gather for the one after
+                if (m_syncWanted > m_synced && m_retired.empty()) {
+                    const uint64_t covered = m_written;
+                    const int fd = m_fd;
+                    lock.unlock();
+                    ::fdatasync(fd);
+                    lock.lock();
+                    m_synced = std::max(m_synced, covered);
+                    m_durable.notify_all();
+                }
+            }
+        }
+
+        /// Moves every file one place down the rotation, putting the spare in place, and prunes the oldest.
+        void m_shift() {
+            struct stat st;
+            size_t count = 0;
+            while (::stat(m_rotatedPath(count + 1).c_str(), &st) == 0) count++;
+
+            for (size_t index = count; index > 0; index--) ::rename(m_rotatedPath(index).c_str(), m_rotatedPath(index + 1).c_str());
+            ::rename(m_opts.path.c_str(), m_rotatedPath(1).c_str());
+            ::rename(m_sparePath().c_str(), m_opts.path.c_str());
+            count++;
+
+            // then drop the oldest files past either limit
+            size_t kept = 0, total = 0;
+            while (kept < count && (m_opts.maxFiles == 0 || kept < m_opts.maxFiles)) {
+                const size_t size = ::stat(m_rotatedPath(kept + 1).c_str(), &st) == 0 ? static_cast<size_t>(st.st_size) : 0;
+                if (m_opts.maxTotalSize > 0 && total + size > m_opts.maxTotalSize) break;
+                total += size;
+                kept++;
+            }
+            for (size_t index = kept + 1; index <= count; index++) ::unlink(m_rotatedPath(index).c_str());
+        }
+    };
+#endif
+
+#if defined(__linux__) && defined(__NR_io_uring_setup)
+    /// File sink writing through io_uring. Lines are gathered into a small pool of buffers registered
+    /// with the kernel, and each filled buffer is queued as a single write while the next one is filled.
+    /// The writing thread never waits on the storage unless every buffer is still being written. Falls
+    /// back to plain `pwrite` where io_uring is unavailable, such as on older kernels or under seccomp.
+    class UringSink : public Sink {
+       public:
+        /**
+         * Opens the file for appending, throwing `std::system_error` if it cannot be.
+         * @param path                          File path.
+         * @param bufferSize                    Bytes in each buffer.
+         * @param bufferCount                   Buffers in the pool, and so the most writes in flight.
+         */
+        explicit UringSink(const std::string& path, size_t bufferSize = 256 * 1024, size_t bufferCount = 4) : m_bufferSize(bufferSize), m_buffers(std::max<size_t>(bufferCount, 2)) {
+            m_fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_CLOEXEC, 0644);
+            if (m_fd < 0) throw std::system_error(errno, std::generic_category(), "tiny::UringSink: open " + path);
+
+            struct stat st;
+            m_offset = ::fstat(m_fd, &st) == 0 ? static_cast<uint64_t>(st.st_size) : 0;
+
+            m_pool.reset(new char[m_bufferSize * m_buffers.size()]);
+            for (size_t ii = 0; ii < m_buffers.size(); ii++) m_buffers[ii].data = m_pool.get() + ii * m_bufferSize;
+
+            m_setup();
+        }
+
+        ~UringSink() {
+            {
+                std::lock_guard<std::mutex> guard(m_lock);
+                m_submit();
+                for (Buffer& buffer : m_buffers)
+                    while (buffer.busy) m_reap(true);
+            }
+            m_teardown();
+            ::close(m_fd);
+        }
+
+        UringSink(const UringSink&) = delete;
+        UringSink& operator=(const UringSink&) = delete;
+
+        void write(const Logger::Severity&, const char* data, size_t len) override {
+            std::lock_guard<std::mutex> guard(m_lock);
+            while (len > 0) {
+                Buffer& buffer = m_buffers[m_current];
+                const size_t count = std::min(len, m_bufferSize - buffer.used);
+                std::memcpy(buffer.data + buffer.used, data, count);
+                buffer.used += count;
+                data += count;
+                len -= count;
+                if (buffer.used == m_bufferSize) m_submit();
+            }
+        }
+
+        /// Queues the current buffer to be written, without waiting for it.
+        void flush() override {
+            std::lock_guard<std::mutex> guard(m_lock);
+            m_submit();
+        }
+
+        void sync() override {
+            std::lock_guard<std::mutex> guard(m_lock);
+            m_submit();
+            for (Buffer& buffer : m_buffers)
+                while (buffer.busy) m_reap(true);
+            ::fdatasync(m_fd);
+        }
+
+        /// Whether writes are going through io_uring, rather than the `pwrite` fallback.
+        bool uring() const { return m_ring >= 0; }
+
+       private:
+        /// Pooled buffer, busy while the kernel is writing it out.
+        struct Buffer {
+            char* data = nullptr;
+            size_t used = 0;
+            uint64_t offset = 0;
+            bool busy = false;
+        };
+
+        /// The parts of the io_uring kernel interface used here, declared rather than included so the
+        /// header does not bring `<linux/io_uring.h>` and the kernel's macros into every translation unit.
+        struct SqOffsets {
+            uint32_t head, tail, ringMask, ringEntries, flags, dropped, array, reserved;
+            uint64_t userAddr;
+        };
+        struct CqOffsets {
+            uint32_t head, tail, ringMask, ringEntries, overflow, cqes, flags, reserved;
+            uint64_t userAddr;
+        };
+        struct Params {
+            uint32_t sqEntries, cqEntries, flags, sqThreadCpu, sqThreadIdle, features, wqFd, reserved[3];
+            SqOffsets sqOff;
+            CqOffsets cqOff;
+        };
+        struct Sqe {
+            uint8_t opcode, flags;
+            uint16_t ioprio;
+            int32_t fd;
+            uint64_t off, addr;
+            uint32_t len, rwFlags;
+            uint64_t userData;
+            uint16_t bufIndex, personality;
+            int32_t spliceFdIn;
+            uint64_t pad[2];
+        };
+        struct Cqe {
+            uint64_t userData;
+            int32_t res;
+            uint32_t flags;
+        };
+
+        static_assert(sizeof(Params) == 120 && sizeof(Sqe) == 64 && sizeof(Cqe) == 16, "must match the kernel's layout");
+
+        static constexpr off_t OFF_SQ_RING = 0;
+        static constexpr off_t OFF_CQ_RING = 0x8000000;
+        static constexpr off_t OFF_SQES = 0x10000000;
+        static constexpr uint32_t FEAT_SINGLE_MMAP = 1U << 0;
+        static constexpr uint8_t OP_WRITE_FIXED = 5;
+        static constexpr uint8_t OP_WRITE = 23;
+        static constexpr unsigned ENTER_GETEVENTS = 1U << 0;
+        static constexpr unsigned REGISTER_BUFFERS = 0;
+
+        size_t m_bufferSize;
+        std::vector<Buffer> m_buffers;
+        std::unique_ptr<char[]> m_pool;
+        std::mutex m_lock;
+        size_t m_current = 0;
+        uint64_t m_offset = 0;
+        int m_fd = -1;
+
+        /// Ring state, mapped from the kernel.
+        int m_ring = -1;
+        bool m_registered = false;
+        void* m_sqMap = MAP_FAILED;
+        void* m_cqMap = MAP_FAILED;
+        size_t m_sqMapSize = 0;
+        size_t m_cqMapSize = 0;
+        Sqe* m_sqes = static_cast<Sqe*>(MAP_FAILED);
+        size_t m_sqesSize = 0;
+        std::atomic<uint32_t>* m_sqTail = nullptr;
+        uint32_t m_sqMask = 0;
+        uint32_t* m_sqArray = nullptr;
+        std::atomic<uint32_t>* m_cqHead = nullptr;
+        std::atomic<uint32_t>* m_cqTail = nullptr;
+        uint32_t m_cqMask = 0;
+        Cqe* m_cqes = nullptr;
+
+        static_assert(sizeof(std::atomic<uint32_t>) == sizeof(uint32_t) && std::atomic<uint32_t>::is_always_lock_free, "ring indices are shared with the kernel");
+
+        template <typename T>
+        static T* m_at(void* map, uint32_t offset) { return reinterpret_cast<T*>(static_cast<char*>(map) + offset); }
+
+        static int m_enter(int ring, unsigned submit, unsigned complete, unsigned flags) { return static_cast<int>(::syscall(__NR_io_uring_enter, ring, submit, complete, flags, nullptr, 0)); }
+
+        /// Sets up the ring and registers the buffers, leaving it unset to fall back on any failure.
+        void m_setup() {
+            Params params = {};
+            m_ring = static_cast<int>(::syscall(__NR_io_uring_setup, static_cast<unsigned>(m_buffers.size()), &params));
+            if (m_ring < 0) return;
+
+            m_sqMapSize = params.sqOff.array + params.sqEntries * sizeof(uint32_t);
+            m_cqMapSize = params.cqOff.cqes + params.cqEntries * sizeof(Cqe);
+            if (params.features & FEAT_SINGLE_MMAP) m_sqMapSize = m_cqMapSize = std::max(m_sqMapSize, m_cqMapSize);
+            m_sqesSize = params.sqEntries * sizeof(Sqe);
+
+            m_sqMap = ::mmap(nullptr, m_sqMapSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, m_ring, OFF_SQ_RING);
+            m_cqMap = (params.features & FEAT_SINGLE_MMAP) ? m_sqMap : ::mmap(nullptr, m_cqMapSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, m_ring, OFF_CQ_RING);
+            m_sqes = static_cast<Sqe*>(::mmap(nullptr, m_sqesSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, m_ring, OFF_SQES));
+            if (m_sqMap == MAP_FAILED || m_cqMap == MAP_FAILED || m_sqes == MAP_FAILED) return m_teardown();
+
+            m_sqTail = m_at<std::atomic<uint32_t>>(m_sqMap, params.sqOff.tail);
+            m_sqMask = *m_at<uint32_t>(m_sqMap, params.sqOff.ringMask);
+            m_sqArray = m_at<uint32_t>(m_sqMap, params.sqOff.array);
+            m_cqHead = m_at<std::atomic<uint32_t>>(m_cqMap, params.cqOff.head);
+            m_cqTail = m_at<std::atomic<uint32_t>>(m_cqMap, params.cqOff.tail);
+            m_cqMask = *m_at<uint32_t>(m_cqMap, params.cqOff.ringMask);
+            m_cqes = m_at<Cqe>(m_cqMap, params.cqOff.cqes);
+
+            // registered buffers save the kernel pinning pages on every write, but count against the
+            // locked memory limit, so plain writes are used when that is too low
+            std::vector<iovec> iovecs(m_buffers.size());
+            for (size_t ii = 0; ii < m_buffers.size(); ii++) iovecs[ii] = {m_buffers[ii].data, m_bufferSize};
+            m_registered = ::syscall(__NR_io_uring_register, m_ring, REGISTER_BUFFERS, iovecs.data(), static_cast<unsigned>(iovecs.size())) == 0;
+        }
+
+        void m_teardown() {
+            if (m_sqes != MAP_FAILED) ::munmap(m_sqes, m_sqesSize);
+            if (m_cqMap != MAP_FAILED && m_cqMap != m_sqMap) ::munmap(m_cqMap, m_cqMapSize);
+            if (m_sqMap != MAP_FAILED) ::munmap(m_sqMap, m_sqMapSize);
+            if (m_ring >= 0) ::close(m_ring);
+            m_sqes = static_cast<Sqe*>(MAP_FAILED);
+            m_sqMap = m_cqMap = MAP_FAILED;
+            m_ring = -1;
+        }
+
+        /// Writes what the kernel did not, synchronously.
+        void m_finish(const char* data, size_t len, uint64_t offset) {
+            while (len > 0) {
+                const ssize_t written = ::pwrite(m_fd, data, len, static_cast<off_t>(offset));
+                if (written < 0) {
+                    if (errno == EINTR) continue;
+                    return;
+                }
+                data += written;
+                len -= static_cast<size_t>(written);
+                offset += static_cast<uint64_t>(written);
+            }
+        }
+
+        /// Queues the current buffer and moves on to the next, waiting for it to come back if it is
+        /// still being written. Each buffer is given its place in the file up front, so writes may complete
+        /// in any order. Expects the lock held.
+        void m_submit() {
+            Buffer& buffer = m_buffers[m_current];
+            if (buffer.used == 0) return;
+            buffer.offset = m_offset;
+            m_offset += buffer.used;
+
+            if (m_ring < 0) {
+                m_finish(buffer.data, buffer.used, buffer.offset);
+                buffer.used = 0;
+                return;
+            }
+
+            const uint32_t tail = m_sqTail->load(std::memory_order_relaxed);
+            Sqe& sqe = m_sqes[tail & m_sqMask];
+            sqe = {};
+            sqe.opcode = m_registered ? OP_WRITE_FIXED : OP_WRITE;
+            sqe.fd = m_fd;
+            sqe.addr = reinterpret_cast<uint64_t>(buffer.data);
+            sqe.len = static_cast<uint32_t>(buffer.used);
+            sqe.off = buffer.offset;
+            sqe.bufIndex = static_cast<uint16_t>(m_current);
+            sqe.userData = m_current;
+            m_sqArray[tail & m_sqMask] = tail & m_sqMask;
+            m_sqTail->store(tail + 1, std::memory_order_release);
+
+            buffer.busy = true;
+            while (m_enter(m_ring, 1, 0, 0) < 0 && errno == EINTR) {}
+
+            m_current = (m_current + 1) % m_buffers.size();
+            m_reap(false);
+            while (m_buffers[m_current].busy) m_reap(true);
+        }
+
+        /// Takes back buffers the kernel has finished with, optionally waiting for at least one. Expects the lock held.
+        void m_reap(bool wait) {
+            if (wait) m_enter(m_ring, 0, 1, ENTER_GETEVENTS);
+
+            uint32_t head = m_cqHead->load(std::memory_order_relaxed);
+            const uint32_t tail = m_cqTail->load(std::memory_order_acquire);
+            for (; head != tail; head++) {
+                const Cqe& cqe = m_cqes[head & m_cqMask];
+                Buffer& buffer = m_buffers[cqe.userData];
+                const size_t written = cqe.res > 0 ? static_cast<size_t>(cqe.res) : 0;
+                if (written < buffer.used) m_finish(buffer.data + written, buffer.used - written, buffer.offset + written);
+                buffer.used = 0;
+                buffer.busy = false;
+            }
+            m_cqHead->store(head, std::memory_order_release);
+        }
+    };
+#endif
+
+#if defined(__linux__)
+    /// File sink appending straight into a shared mapping of the file, so writing a line is a copy
+    /// and an atomic bump of the end offset, with no system calls. The file is preallocated in large
+    /// extents and the mapping grown as needed. What is written survives the process crashing, as it
+    /// is already in the page cache, though the file may then end in zeros up to the extent boundary.
+    /// When it is opened again, writing resumes after the last non-zero byte.
+    class MappedSink : public Sink {
+       public:
+        /**
+         * Opens or creates the file, throwing `std::system_error` if it cannot be mapped.
+         * @param path                          File path.
+         * @param extent                        Bytes the file grows by at a time.
+         * @param sync                          Whether flushing waits for the data to reach the disk,
+         *                                      rather than leaving it in the page cache.
+         */
+        explicit MappedSink(const std::string& path, size_t extent = 64 << 20, bool sync = false) : m_sync(sync) {
+            m_page = static_cast<size_t>(::sysconf(_SC_PAGESIZE));
+            m_extent = std::max(m_page, (extent + m_page - 1) / m_page * m_page);
+
+            m_fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+            if (m_fd < 0) throw std::system_error(errno, std::generic_category(), "tiny::MappedSink: open " + path);
+
+            struct stat st;
+            const size_t existing = ::fstat(m_fd, &st) == 0 ? static_cast<size_t>(st.st_size) : 0;
+            const size_t size = (existing / m_extent + 1) * m_extent;
+            void* data = m_reserve(size) ? ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, m_fd, 0) : MAP_FAILED;
+            if (data == MAP_FAILED) {
+                const int err = errno;
+                ::close(m_fd);
+                throw std::system_error(err, std::generic_category(), "tiny::MappedSink: map " + path);
+            }
+
+            // carry on after whatever was written last time, which never contains a zero byte
+            size_t end = existing;
+            while (end > 0 && static_cast<const char*>(data)[end - 1] == '\0') end--;
+            m_head.store(end, std::memory_order_relaxed);
+            m_synced = end;
+            m_map.store(new Mapping{static_cast<char*>(data), size});
+        }
+
+        ~MappedSink() {
+            const Mapping* map = m_map.load();
+            const uint64_t end = std::min<uint64_t>(m_head.load(), map->size);
+            if (m_sync) ::msync(map->data, map->size, MS_SYNC);
+            ::munmap(map->data, map->size);
+            delete map;
+
+            // drop the unused part of the last extent. Should that fail, the zeros left are skipped when
+            // the file is opened again
+            while (::ftruncate(m_fd, static_cast<off_t>(end)) != 0 && errno == EINTR) {}
+            ::close(m_fd);
+        }
+
+        MappedSink(const MappedSink&) = delete;
+        MappedSink& operator=(const MappedSink&) = delete;
+
+        void write(const Logger::Severity&, const char* data, size_t len) override {
+            Rcu::Guard guard;
+            const uint64_t at = m_head.fetch_add(len, std::memory_order_relaxed);
+            const Mapping* map = m_map.load(std::memory_order_acquire);
+            if (at + len > map->size && !(map = m_grow(at + len))) return;
+            std::memcpy(map->data + at, data, len);
+        }
+
+        /// Writes out everything since the last flush and waits for it, when syncing. Otherwise there
+        /// is nothing to do, as the kernel already has the data.
+        void flush() override {
+            if (m_sync) sync();
+        }
+
+        void sync() override {
+            Rcu::Guard guard;
+            std::lock_guard<std::mutex> lock(m_lock);
+            const Mapping* map = m_map.load();
+            const uint64_t end = std::min<uint64_t>(m_head.load(), map->size);
+            const uint64_t from = m_synced / m_page * m_page;
+            ::msync(map->data + from, static_cast<size_t>(end - from), MS_SYNC);
+            m_synced = end;
+        }
+
+       private:
+        /// Mapped range of the file, replaced whenever it grows.
+        struct Mapping {
+            char* data;
+            size_t size;
+        };
+
+        size_t m_page = 0;
+        size_t m_extent = 0;
+        bool m_sync;
+        int m_fd = -1;
+        std::atomic<uint64_t> m_head{0};
+        std::atomic<const Mapping*> m_map{nullptr};
+        std::mutex m_lock;
+        uint64_t m_synced = 0;
+
+        /// Allocates disk space up to the given size, only extending the file where that is unsupported.
+        bool m_reserve(size_t size) {
+            if (::fallocate(m_fd, 0, 0, static_cast<off_t>(size)) == 0) return true;
+            return errno == EOPNOTSUPP && ::ftruncate(m_fd, static_cast<off_t>(size)) == 0;
+        }
+
+        /// Grows the file and mapping to cover the given end, returning the mapping to use, or null
+        /// if there is no more space and the line must be dropped.
+        const Mapping* m_grow(uint64_t end) {
+            std::lock_guard<std::mutex> lock(m_lock);
+            const Mapping* current = m_map.load();
+            if (end <= current->size) return current;
+
+            const size_t size = static_cast<size_t>((end / m_extent + 1) * m_extent);
+            if (!m_reserve(size)) return nullptr;
+
+            // grow in place if the address space allows, so other writers still copying into the old
+            // mapping are unaffected, otherwise map afresh and unmap the old one once they are done
+            void* data = ::mremap(current->data, current->size, size, 0);
+            const bool moved = data == MAP_FAILED;
+            if (moved) data = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, m_fd, 0);
+            if (data == MAP_FAILED) return nullptr;
+
+            const Mapping* next = new Mapping{static_cast<char*>(data), size};
+            m_map.store(next);
+            if (moved) Rcu::retire(current, [](const void* ptr) {
+                const Mapping* map = static_cast<const Mapping*>(ptr);
+                ::munmap(map->data, map->size);
+                delete map;
+            });
+            else Rcu::retire(current, [](const void* ptr) { delete static_cast<const Mapping*>(ptr); });
+            return next;
+        }
+    };
+
+    /// Sink handing lines to a pipe without copying them, for output read by a collector such as a
+    /// sidecar. Lines are appended to page-aligned buffers whose pages are given to the pipe with
+    /// `vmsplice`, so the reader copies them straight out of this process. A spliced byte is never
+    /// written again until the reader has consumed it, which is checked against the bytes still unread
+    /// in the pipe (`FIONREAD`). Anything other than a pipe is written to with plain `write` instead.
+    ///
+    /// This relies on the reader copying the data out with `read`. A reader splicing it onward would
+    /// still be referencing pages when they are reused. Nothing else should be written to the same
+    /// descriptor through a buffer of its own, such as `std::cout`, or lines can be interleaved.
+    class PipeSink : public Sink {
+       public:
+        /**
+         * Constructs a sink over the given descriptor, which must outlive it.
+         * @param fd                            Output descriptor, usually standard output.
+         * @param bufferCount                   Buffers in the pool, each the size of the pipe.
+         */
+        explicit PipeSink(int fd = STDOUT_FILENO, size_t bufferCount = 4) : m_fd(fd), m_buffers(std::max<size_t>(bufferCount, 2)) {
+            struct stat st;
+            m_fifo = ::fstat(m_fd, &st) == 0 && S_ISFIFO(st.st_mode);
+            m_splicing = m_fifo;
+
+            // with a whole pipe's worth between a buffer and the one being filled, it has always been
+            // read by the time it comes round again
+            const size_t page = static_cast<size_t>(::sysconf(_SC_PAGESIZE));
+            const int capacity = m_fifo ? ::fcntl(m_fd, F_GETPIPE_SZ) : -1;
+            m_bufferSize = std::max(static_cast<size_t>(std::max(capacity, 0)), size_t{64 * 1024}) / page * page;
+
+            m_poolSize = m_bufferSize * m_buffers.size();
+            void* pool = ::mmap(nullptr, m_poolSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+            if (pool == MAP_FAILED) throw std::system_error(errno, std::generic_category(), "tiny::PipeSink: mmap");
+            for (size_t ii = 0; ii < m_buffers.size(); ii++) m_buffers[ii].data = static_cast<char*>(pool) + ii * m_bufferSize;
+        }
+
+        /// Spliced pages stay referenced by the pipe until read, so unmapping them here is safe.
+        ~PipeSink() {
+            flush();
+            ::munmap(m_buffers.front().data, m_poolSize);
+        }
+
+        PipeSink(const PipeSink&) = delete;
+        PipeSink& operator=(const PipeSink&) = delete;
+
+        void write(const Logger::Severity&, const char* data, size_t len) override {
+            std::lock_guard<std::mutex> guard(m_lock);
+            while (len > 0) {
+                Buffer& buffer = m_buffers[m_current];
+                const size_t count = std::min(len, m_bufferSize - buffer.used);
+                std::memcpy(buffer.data + buffer.used, data, count);
+                buffer.used += count;
+                data += count;
+                len -= count;
+
+                if (buffer.used == m_bufferSize) {
+                    m_splice();
+                    m_advance();
+                }
+            }
+        }
+
+        /// Gives everything buffered to the pipe. The buffer carries on being filled after it.
+        void flush() override {
+            std::lock_guard<std::mutex> guard(m_lock);
+            m_splice();
+        }
+
+       private:
+        /// Pooled buffer. Bytes up to `spliced` belong to the pipe, and the whole buffer is free again
+        /// once the reader is past `end`, its last byte in the output.
+        struct Buffer {
+            char* data = nullptr;
+            size_t used = 0;
+            size_t spliced = 0;
+            uint64_t end = 0;
+        };
+
+        int m_fd;
+        bool m_fifo = false;
+        bool m_splicing = false;
+        std::vector<Buffer> m_buffers;
+        size_t m_bufferSize = 0;
+        size_t m_poolSize = 0;
+        size_t m_current = 0;
+        uint64_t m_written = 0;
+        std::mutex m_lock;
+
+        /// Hands what is left of the current buffer to the pipe, copying it where splicing is unsupported.
+        /// Expects the lock held.
+        void m_splice() {
+            Buffer& buffer = m_buffers[m_current];
+            while (buffer.spliced < buffer.used) {
+                const char* from = buffer.data + buffer.spliced;
+                const size_t len = buffer.used - buffer.spliced;
+
+                ssize_t written;
+                if (m_splicing) {
+                    iovec iov = {const_cast<char*>(from), len};
+                    written = ::vmsplice(m_fd, &iov, 1, 0);
+                    if (written < 0 && errno != EINTR && errno != EAGAIN) {
+                        m_splicing = false;
+                        continue;
+                    }
+                } else written = ::write(m_fd, from, len);
+
+                if (written < 0) {
+                    if (errno == EINTR || errno == EAGAIN) continue;
+                    buffer.spliced = buffer.used;
+                    break;
+                }
+                buffer.spliced += static_cast<size_t>(written);
+                m_written += static_cast<uint64_t>(written);
+            }
+            buffer.end = m_written;
+        }
+
+        /// Moves on to the next buffer, waiting for the reader to be done with it. Expects the lock held.
+        void m_advance() {
+            m_current = (m_current + 1) % m_buffers.size();
+            Buffer& buffer = m_buffers[m_current];
+
+            while (m_fifo) {
+                int unread = 0;
+                if (::ioctl(m_fd, FIONREAD, &unread) != 0 || m_written >= buffer.end + static_cast<uint64_t>(unread)) break;
+                std::this_thread::sleep_for(std::chrono::microseconds(50));
+            }
+            buffer.used = buffer.spliced = 0;
+        }
+    };
+#endif
+
+    /// Sink handing lines to a background thread, which writes them to another sink. Each thread
+    /// copies its lines into a queue of its own, stamped with `Clock`, so writers never contend with
+    /// each other. The background thread merges the queues back into one stream in stamp order. A line
+    /// goes out once every queue holds a later line, or once it is older than the reorder window. The
+    /// window bounds how long a thread that has stamped a line but not yet queued it can hold up the
+    /// others, so lines only come out of order when queueing one takes longer than the window. Lines
+    /// too long to fit in a queue are copied to the heap, and only a pointer to them is queued, so they
+    /// keep their place among the thread's other lines.
+    ///
+    /// What a writer does when its queue is full is set by the overflow policy. Dropped lines are
+    /// counted by severity, and a notice of how many were dropped is written at most once per
+    /// `dropNoticeInterval`.
+    ///
+    /// When idle, the background thread polls the queues for `pollFor`, then yields for `yieldFor`,
+    /// then parks (on a futex, on Linux). Writers only make a system call to wake it once it has parked.
+    ///
+    /// The other sink is flushed whenever the background thread catches up, so `flush` does nothing,
+    /// and `sync` waits for everything the calling thread has written to go out first.
+    class AsyncSink : public Sink {
+       public:
+        /// What a writer does when its queue is full.
+        enum class Overflow {
+            BLOCK,            ///< Waits for room.
+            SPIN_THEN_BLOCK,  ///< Spins for `spinFor`, then waits for room.
+            DROP_NEWEST,      ///< Drops the line being written.
+            DROP_OLDEST,      ///< Drops the oldest queued lines to make room. Costs a lock per line.
+            DROP_BY_SEVERITY  ///< Drops the line being written, unless at least as severe as `keep`.
+        };
+
+        /// Async Sink Options.
+        struct Options {
+            /// Bytes queued per thread before overflowing, rounded up to a power of two.
+            size_t queueSize = 1024 * 1024;
+
+            /// Longest a line is held back waiting for earlier lines from other threads.
+            std::chrono::microseconds reorderWindow{1000};
+
+            /// What a writer does when its queue is full.
+            Overflow overflow = Overflow::BLOCK;
+
+            /// Time spent spinning before waiting, with `SPIN_THEN_BLOCK`.
+            std::chrono::microseconds spinFor{50};
+
+            /// Least severe level never dropped by `DROP_BY_SEVERITY`, which waits for room instead.
+            Logger::Severity keep = Logger::ERROR;
+
+            /// Shortest time between notices of dropped lines.
+            std::chrono::milliseconds dropNoticeInterval{1000};
+
+            /// Time the idle background thread polls the queues for, then yields for, before parking.
+            std::chrono::microseconds pollFor{20};
+            std::chrono::microseconds yieldFor{50};
+        };
+
+        /**
+         * Starts the background thread writing to the given sink.
+         * @param target                        Sink lines are written to.
+         * @param opts                          Async sink options.
+         */
+        AsyncSink(std::shared_ptr<Sink> target, const Options& opts) : m_target(std::move(target)), m_opts(opts) {
+            m_capacity = std::max<size_t>(64, m_opts.queueSize);
+            while ((m_capacity & (m_capacity - 1)) != 0) m_capacity += m_capacity & -m_capacity;
+            m_thread = std::thread([this] { m_worker(); });
+        }
+
+        /// Starts the background thread writing to the given sink with default options.
+        explicit AsyncSink(std::shared_ptr<Sink> target) : AsyncSink(std::move(target), Options()) {}
+
+        /// Writes out everything still queued before returning.
+        ~AsyncSink() {
+            {
+                std::lock_guard<std::mutex> guard(m_lock);
+                m_stopping = true;
+            }
+
+            m_request();
+            m_thread.join();
+        }
+
+        AsyncSink(const AsyncSink&) = delete;
+        AsyncSink& operator=(const AsyncSink&) = delete;
+
+        void write(const Logger::Severity& sev, const char* data, size_t len) override {
+            Queue& queue = m_queue();
+            const uint64_t stamp = Clock::now();
+
+            // lines too long to queue are queued as a pointer to a copy of their own
+            const bool large = m_recordSize(len) > m_capacity / 2;
+            const size_t size = m_recordSize(large ? sizeof(std::string*) : len);
+
+            // a record that would run past the end of the queue starts again at the front
+            uint64_t tail = queue.tail.load(std::memory_order_relaxed);
+            const size_t offset = static_cast<size_t>(tail & (m_capacity - 1));
+            const size_t padding = m_capacity - offset < size ? m_capacity - offset : 0;
+            if (!m_makeRoom(queue, sev, padding + size)) {
+                m_dropped[sev].fetch_add(1, std::memory_order_relaxed);
+                return;
+            }
+
+            if (padding >= sizeof(Header)) {
+                const Header wrap{0, WRAP, 0, false};
+                std::memcpy(queue.data.get() + offset, &wrap, sizeof(wrap));
+            }
+            tail += padding;
+
+            char* at = queue.data.get() + (tail & (m_capacity - 1));
+            const Header header{stamp, large ? 0 : static_cast<uint32_t>(len), static_cast<uint8_t>(sev), large};
+            std::memcpy(at, &header, sizeof(header));
+            if (large) {
+                const std::string* line = new std::string(data, len);
+                std::memcpy(at + sizeof(header), &line, sizeof(line));
+            } else {
+                std::memcpy(at + sizeof(header), data, len);
+            }
+            queue.tail.store(tail + size, std::memory_order_release);
+
+            m_signal();
+        }
+
+        /// Waits until every line written so far by the calling thread has been written to the other
+        /// sink, then syncs it.
+        void sync() override {
+            const uint64_t stamp = Clock::now();
+            std::unique_lock<std::mutex> lock(m_lock);
+            m_syncWaiters++;
+            lock.unlock();
+
+            m_request();
+            lock.lock();
+            m_caughtUp.wait(lock, [this, stamp] { return m_watermark > stamp; });
+            m_syncWaiters--;
+            lock.unlock();
+
+            m_target->sync();
+        }
+
+        bool terminal() const override { return m_target->terminal(); }
+
+        /// Writes out whatever is queued, in stamp order and without taking any locks, after whatever the
+        /// other sink still buffers. Lines go through the other sink when it is signal-safe, and straight to
+        /// its descriptor otherwise, if it has one. The line the background thread is writing for each thread
+        /// at the time may be lost.
+        void emergencyFlush() override {
+            m_target->emergencyFlush();
+            const bool direct = m_target->signalSafe();
+            const int fd = direct ? -1 : m_target->emergencyFd();
+            if (!direct && fd < 0) return;
+
+            while (true) {
+                Queue* oldest = nullptr;
+                const Header* first = nullptr;
+                for (Queue* queue = m_first.load(std::memory_order_acquire); queue; queue = queue->next) {
+                    uint64_t head = queue->head.load(std::memory_order_acquire);
+                    const Header* header = m_peek(*queue, head);
+                    if (header && (!first || header->stamp < first->stamp)) {
+                        oldest = queue;
+                        first = header;
+                    }
+                }
+                if (!first) return;
+
+                const std::string_view line = m_line(*first);
+                if (direct) m_target->write(static_cast<Logger::Severity>(first->severity), line.data(), line.size());
+                else m_writeAll(fd, line.data(), line.size());
+
+                // the queue is given up on here, so its head can be moved from this side
+                uint64_t head = oldest->head.load(std::memory_order_acquire);
+                m_peek(*oldest, head);
+                oldest->head.store(head + m_recordSize(*first), std::memory_order_release);
+            }
+        }
+
+        int emergencyFd() const override { return m_target->emergencyFd(); }
+
+        /// Lines dropped so far, indexed by severity.
+        std::array<uint64_t, 5> dropped() const {
+            std::array<uint64_t, 5> counts;
+            for (size_t ii = 0; ii < counts.size(); ii++) counts[ii] = m_dropped[ii].load(std::memory_order_relaxed);
+            return counts;
+        }
+
+       private:
+        /// Record header, followed by the line itself, or by a pointer to a heap copy of it when large.
+        struct Header {
+            uint64_t stamp;
+            uint32_t size;
+            uint8_t severity;
+            bool large;
+        };
+
+        /// Header size marking the rest of the queue as unused, with records carrying on at the front.
+        static constexpr uint32_t WRAP = UINT32_MAX;
+
+        /// Single producer, single consumer queue of records, owned by one writing thread at a time.
+        /// Only `DROP_OLDEST` moves the head from the producer, under the lock.
+        struct Queue {
+            std::unique_ptr<char[]> data;
+            Queue* next = nullptr;
+            std::mutex lock;
+            std::atomic<bool> closed{false};
+            std::atomic<bool> waiting{false};
+            alignas(64) std::atomic<uint64_t> head{0};
+            alignas(64) std::atomic<uint64_t> tail{0};
+        };
+
+        /// Thread's handle on one sink's queue, dropped once the sink is gone.
+        struct Handle {
+            uint64_t id;
+            std::weak_ptr<void> alive;
+            std::shared_ptr<Queue> queue;
+        };
+
+        /// Per-thread queue handles, which close their queues when the thread exits.
+        struct Registration {
+            std::vector<Handle> handles;
+
+            ~Registration() {
+                for (Handle& handle : handles) handle.queue->closed.store(true, std::memory_order_release);
+            }
+        };
+
+        /// Oldest line of a queue, taken out by the background thread while it waits to be merged.
+        struct Front {
+            bool taken = false;
+            uint64_t stamp = 0;
+            Logger::Severity severity = Logger::TRACE;
+            std::string data;
+        };
+
+        std::shared_ptr<Sink> m_target;
+        Options m_opts;
+        size_t m_capacity;
+
+        /// Unique sink identifier, keying the per-thread queues, and a token threads see expire once
+        /// the sink is destroyed, so they let go of its queues.
+        static inline std::atomic<uint64_t> m_nextId{1};
+        const uint64_t m_id = m_nextId.fetch_add(1, std::memory_order_relaxed);
+        const std::shared_ptr<void> m_alive = std::make_shared<char>();
+
+        /// Every queue, kept until the sink is destroyed. Queues closed and drained are handed to new
+        /// threads. They are also linked from `m_first`, newest first, for the emergency path.
+        std::vector<std::shared_ptr<Queue>> m_queues;
+        std::atomic<Queue*> m_first{nullptr};
+
+        /// Lines dropped, indexed by severity.
+        std::array<std::atomic<uint64_t>, 5> m_dropped{};
+
+        /// Background thread state, shared under the lock. `m_parked` is the futex word the idle thread
+        /// parks on, and `m_signalled` asks for a pass over the queues besides any new lines.
+        std::thread m_thread;
+        std::mutex m_lock;
+        std::condition_variable m_wake;
+        std::condition_variable m_room;
+        std::condition_variable m_caughtUp;
+        std::atomic<uint32_t> m_parked{0};
+        std::atomic<bool> m_signalled{false};
+        std::atomic<size_t> m_generation{0};
+        size_t m_syncWaiters = 0;
+        uint64_t m_watermark = 0;
+        bool m_stopping = false;
+
+        /// Queue space taken by a line, keeping headers aligned.
+        static size_t m_recordSize(size_t len) { return (sizeof(Header) + len + alignof(Header) - 1) & ~(alignof(Header) - 1); }
+
+        static size_t m_recordSize(const Header& header) { return m_recordSize(header.large ? sizeof(std::string*) : header.size); }
+
+        /// Heap copy of a large record's line.
+        static std::string* m_heapLine(const Header& header) {
+            std::string* line;
+            std::memcpy(&line, &header + 1, sizeof(line));
+            return line;
+        }
+
+        /// Writes all of the given data to a descriptor, as far as it will go. Async-signal-safe.
+        static void m_writeAll(int fd, const char* data, size_t len) {
+            while (len > 0) {
+                const ssize_t written = ::write(fd, data, len);
+                if (written < 0) {
+                    if (errno == EINTR) continue;
+                    return;
+                }
+                data += written;
+                len -= static_cast<size_t>(written);
+            }
+        }
+
+        /// Line a record holds.
+        static std::string_view m_line(const Header& header) {
+            if (header.large) return *m_heapLine(header);
+            return std::string_view(reinterpret_cast<const char*>(&header + 1), header.size);
+        }
+
+        /// Whether a writer of the given severity waits for room rather than dropping lines.
+        bool m_blocks(const Logger::Severity& sev) const {
+            switch (m_opts.overflow) {
+                case Overflow::BLOCK:
+                case Overflow::SPIN_THEN_BLOCK:
+                    return true;
+                case Overflow::DROP_BY_SEVERITY:
+                    return sev <= m_opts.keep;
+                default:
+                    return false;
+            }
+        }
+
+        /// Queue for the calling thread, registering one on first use.
+        Queue& m_queue() {
+            thread_local Registration registration;
+            for (Handle& handle : registration.handles)
+                if (handle.id == m_id) return *handle.queue;
+
+            auto& handles = registration.handles;
+            handles.erase(std::remove_if(handles.begin(), handles.end(), [](const Handle& handle) { return handle.alive.expired(); }), handles.end());
+
+            std::lock_guard<std::mutex> guard(m_lock);
+            std::shared_ptr<Queue> queue;
+            for (auto& candidate : m_queues)
+                if (candidate->closed.load(std::memory_order_acquire) && candidate->head.load() == candidate->tail.load()) {
+                    candidate->closed.store(false, std::memory_order_relaxed);
+                    queue = candidate;
+                    break;
+                }
+
+            if (!queue) {
+                queue = std::make_shared<Queue>();
+                queue->data.reset(new char[m_capacity]);
+                queue->next = m_first.load(std::memory_order_relaxed);
+                m_first.store(queue.get(), std::memory_order_release);
+                m_queues.push_back(queue);
+                m_generation.fetch_add(1);
+            }
+
+            handles.push_back({m_id, m_alive, queue});
+            return *queue;
+        }
+
+        /**
+         * Makes room in the calling thread's queue as the overflow policy allows.
+         * @param queue                         Calling thread's queue.
+         * @param sev                           Severity of the line being written.
+         * @param size                          Bytes needed.
+         * @returns                             Whether there is room, or the line must be dropped.
+         */
+        bool m_makeRoom(Queue& queue, const Logger::Severity& sev, size_t size) {
+            const uint64_t tail = queue.tail.load(std::memory_order_relaxed);
+            if (m_capacity - (tail - queue.head.load(std::memory_order_acquire)) >= size) return true;
+
+            switch (m_opts.overflow) {
+                case Overflow::SPIN_THEN_BLOCK: {
+                    const auto until = std::chrono::steady_clock::now() + m_opts.spinFor;
+                    m_signal();
+                    while (m_capacity - (tail - queue.head.load(std::memory_order_acquire)) < size && std::chrono::steady_clock::now() < until) {
+#if defined(TINY_LOGGER_TSC)
+                        _mm_pause();
+#endif
+                    }
+                    break;
+                }
+                case Overflow::DROP_OLDEST: {
+                    std::lock_guard<std::mutex> guard(queue.lock);
+                    uint64_t head = queue.head.load(std::memory_order_relaxed);
+                    while (m_capacity - (tail - head) < size) {
+                        const Header* header = m_peek(queue, head);
+                        m_dropped[header->severity].fetch_add(1, std::memory_order_relaxed);
+                        if (header->large) delete m_heapLine(*header);
+                        head += m_recordSize(*header);
+                    }
+                    queue.head.store(head, std::memory_order_release);
+                    return true;
+                }
+                default:
+                    break;
+            }
+
+            if (!m_blocks(sev)) return false;
+            m_waitForRoom(queue, size);
+            return true;
+        }
+
+        /**
+         * Waits until the calling thread's queue has room.
+         * @param queue                         Calling thread's queue.
+         * @param size                          Bytes needed.
+         */
+        void m_waitForRoom(Queue& queue, size_t size) {
+            const uint64_t tail = queue.tail.load(std::memory_order_relaxed);
+            const auto roomy = [&] { return m_capacity - (tail - queue.head.load()) >= size; };
+            if (roomy()) return;
+
+            queue.waiting.store(true);
+            m_request();
+
+            std::unique_lock<std::mutex> lock(m_lock);
+            m_room.wait(lock, roomy);
+            queue.waiting.store(false, std::memory_order_relaxed);
+        }
+
+        /// Wakes the background thread after a line is queued, if it has parked. The fence orders the
+        /// line before the check, against the background thread parking before it looks again.
+        void m_signal() {
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            if (m_parked.load(std::memory_order_relaxed) != 0) m_unpark();
+        }
+
+        /// Asks the background thread for a pass over the queues, waking it if needed. Must not be
+        /// called with the lock held.
+        void m_request() {
+            m_signalled.store(true);
+            m_unpark();
+        }
+
+        /// Wakes the parked background thread, making the system call from one writer only.
+        void m_unpark() {
+            if (m_parked.exchange(0) == 0) return;
+#if defined(__linux__)
+            ::syscall(SYS_futex, reinterpret_cast<uint32_t*>(&m_parked), FUTEX_WAKE_PRIVATE, 1, nullptr, nullptr, 0);
+#else
+            std::lock_guard<std::mutex> guard(m_lock);
+            m_wake.notify_one();
+#endif
+        }
+
+        /**
+         * Parks the background thread until woken, or until the given time.
+         * @param until                         Time to stop waiting at, if any.
+         */
+        void m_park(std::optional<std::chrono::steady_clock::time_point> until) {
+#if defined(__linux__)
+            timespec timeout = {};
+            if (until) {
+                const auto left = std::max<std::chrono::nanoseconds>(*until - std::chrono::steady_clock::now(), std::chrono::nanoseconds(0));
+                timeout.tv_sec = static_cast<time_t>(left.count() / 1000000000);
+                timeout.tv_nsec = static_cast<long>(left.count() % 1000000000);
+            }
+            ::syscall(SYS_futex, reinterpret_cast<uint32_t*>(&m_parked), FUTEX_WAIT_PRIVATE, 1, until ? &timeout : nullptr, nullptr, 0);
+#else
+            std::unique_lock<std::mutex> lock(m_lock);
+            const auto unparked = [this] { return m_parked.load() == 0; };
+            if (until) m_wake.wait_until(lock, *until, unparked);
+            else m_wake.wait(lock, unparked);
+#endif
+        }
+
+        /**
+         * Whether there is anything for the background thread to do. Queues whose oldest line has been
+         * taken out already are skipped, as later lines there change nothing until it goes out.
+         * @param queues                        Queues known to the background thread.
+         * @param fronts                        Lines taken out of them.
+         * @param generation                    Generation of the queue list known to the background thread.
+         */
+        bool m_hasWork(const std::vector<std::shared_ptr<Queue>>& queues, const std::vector<Front>& fronts, size_t generation) const {
+            if (m_signalled.load() || m_generation.load() != generation) return true;
+            for (size_t ii = 0; ii < queues.size(); ii++)
+                if (!fronts[ii].taken && queues[ii]->head.load(std::memory_order_relaxed) != queues[ii]->tail.load(std::memory_order_acquire)) return true;
+            return false;
+        }
+
+        /**
+         * Waits for more work, polling, then yielding, then parking.
+         * @param queues                        Queues known to the background thread.
+         * @param fronts                        Lines taken out of them.
+         * @param generation                    Generation of the queue list known to the background thread.
+         * @param until                         Time to stop waiting at, if any.
+         */
+        void m_idle(const std::vector<std::shared_ptr<Queue>>& queues, const std::vector<Front>& fronts, size_t generation, std::optional<std::chrono::steady_clock::time_point> until) {
+            const auto since = std::chrono::steady_clock::now();
+            while (!m_hasWork(queues, fronts, generation)) {
+                const auto now = std::chrono::steady_clock::now();
+                if (until && now >= *until) return;
+
+                if (now - since < m_opts.pollFor) {
+#if defined(TINY_LOGGER_TSC)
+                    _mm_pause();
+#endif
+                    continue;
+                }
+
+                if (now - since < m_opts.pollFor + m_opts.yieldFor) {
+                    std::this_thread::yield();
+                    continue;
+                }
+
+                // writers see the flag before their next check, or the line is seen here. The fence pairs
+                // with the one in m_signal, keeping the queue checks from moving ahead of the flag
+                m_parked.store(1);
+                std::atomic_thread_fence(std::memory_order_seq_cst);
+                if (!m_hasWork(queues, fronts, generation)) m_park(until);
+                m_parked.store(0);
+                return;
+            }
+        }
+
+        /**
+         * Oldest record in a queue, skipping over the unused end, or null if there is none.
+         * @param queue                         Queue to look in.
+         * @param head                          Read position, moved past any unused end.
+         */
+        const Header* m_peek(const Queue& queue, uint64_t& head) const {
+            while (head != queue.tail.load(std::memory_order_acquire)) {
+                const size_t offset = static_cast<size_t>(head & (m_capacity - 1));
+                const Header* header = reinterpret_cast<const Header*>(queue.data.get() + offset);
+                if (m_capacity - offset >= sizeof(Header) && header->size != WRAP) return header;
+                head += m_capacity - offset;
+            }
+            return nullptr;
+        }
+
+        /**
+         * Takes the oldest line out of a queue, freeing its room straight away.
+         * @param queue                         Queue to take from.
+         * @param front                         Where the line is kept until it is merged.
+         */
+        void m_take(Queue& queue, Front& front) {
+            std::unique_lock<std::mutex> guard(queue.lock, std::defer_lock);
+            if (m_opts.overflow == Overflow::DROP_OLDEST) guard.lock();
+
+            uint64_t head = queue.head.load(std::memory_order_acquire);
+            const Header* header = m_peek(queue, head);
+            if (!header) return;
+
+            front.taken = true;
+            front.stamp = header->stamp;
+            front.severity = static_cast<Logger::Severity>(header->severity);
+            std::unique_ptr<std::string> line(header->large ? m_heapLine(*header) : nullptr);
+            if (line) front.data.swap(*line);
+            else front.data.assign(reinterpret_cast<const char*>(header + 1), header->size);
+            queue.head.store(head + m_recordSize(*header));
+
+            if (queue.waiting.load()) {
+                std::lock_guard<std::mutex> lock(m_lock);
+                m_room.notify_all();
+            }
+        }
+
+        /// Writes a notice of any lines dropped since the last one.
+        void m_noticeDrops(std::array<uint64_t, 5>& noticed) {
+            const std::array<uint64_t, 5> counts = dropped();
+            if (counts == noticed) return;
+
+            std::string line = "tiny::AsyncSink: dropped ";
+            uint64_t total = 0;
+            for (size_t ii = 0; ii < counts.size(); ii++) total += counts[ii] - noticed[ii];
+            line += std::to_string(total) + " records (";
+            for (size_t ii = 0; ii < counts.size(); ii++) {
+                static constexpr const char* NAMES[] = {"FATAL", "ERROR", "WARNING", "INFO", "TRACE"};
+                line += std::string(ii > 0 ? ", " : "") + NAMES[ii] + " " + std::to_string(counts[ii] - noticed[ii]);
+            }
+            line += ")\n";
+
+            m_target->write(Logger::WARNING, line.data(), line.size());
+            noticed = counts;
+        }
+
+        void m_worker() {
+            const Clock::Calibration calibration = Clock::calibrate();
+            const auto window = static_cast<uint64_t>(static_cast<double>(std::chrono::nanoseconds(m_opts.reorderWindow).count()) / calibration.nanosPerTick);
+
+            std::vector<std::shared_ptr<Queue>> queues;
+            std::vector<Front> fronts;
+            size_t generation = SIZE_MAX;
+            std::array<uint64_t, 5> noticed{};
+            auto nextNotice = std::chrono::steady_clock::now();
+
+            std::unique_lock<std::mutex> lock(m_lock);
+            while (true) {
+                if (generation != m_generation.load()) {
+                    generation = m_generation.load();
+                    queues = m_queues;
+                    fronts.resize(queues.size());
+                }
+                const bool stopping = m_stopping;
+                m_signalled.store(false);
+                lock.unlock();
+
+                // anything stamped before the scan started is either already queued or held up
+                const uint64_t start = Clock::now();
+
+                // merge the queues, for as long as the oldest line is known to be the oldest
+                bool wrote = false;
+                std::optional<uint64_t> deadline;
+                uint64_t watermark = start;
+                while (true) {
+                    Front* oldest = nullptr;
+                    bool complete = true;
+                    for (size_t ii = 0; ii < queues.size(); ii++) {
+                        const bool closed = queues[ii]->closed.load(std::memory_order_acquire);
+                        if (!fronts[ii].taken) m_take(*queues[ii], fronts[ii]);
+                        if (!fronts[ii].taken) complete = complete && closed;
+                        else if (!oldest || fronts[ii].stamp < oldest->stamp) oldest = &fronts[ii];
+                    }
+                    if (!oldest) break;
+
+                    if (!complete && !stopping && Clock::now() - oldest->stamp < window) {
+                        deadline = oldest->stamp + window;
+                        watermark = std::min(watermark, oldest->stamp);
+                        break;
+                    }
+
+                    m_target->write(oldest->severity, oldest->data.data(), oldest->data.size());
+                    oldest->taken = false;
+                    wrote = true;
+                }
+
+                // dropped lines are owned up to at most once per interval
+                const auto now = std::chrono::steady_clock::now();
+                if (now >= nextNotice || stopping) {
+                    m_noticeDrops(noticed);
+                    nextNotice = now + m_opts.dropNoticeInterval;
+                    wrote = true;
+                }
+                if (wrote) m_target->flush();
+
+                lock.lock();
+                m_watermark = watermark;
+                if (m_syncWaiters > 0) m_caughtUp.notify_all();
+                if (stopping) break;
+
+                lock.unlock();
+
+                // a held back line is due by the end of its window, and a notice still owed by the end of the interval
+                std::optional<std::chrono::steady_clock::time_point> until;
+                if (deadline) until = std::chrono::steady_clock::now() + std::chrono::nanoseconds(static_cast<int64_t>(static_cast<double>(*deadline - std::min(*deadline, Clock::now())) * calibration.nanosPerTick));
+                if (dropped() != noticed) until = std::min(until.value_or(nextNotice), nextNotice);
+
+                m_idle(queues, fronts, generation, until);
+                lock.lock();
+            }
+        }
+    };
+
+    /**********************
+     *  LOGGER HIERARCHY  *
+     **********************/
+
+    inline Logger& Logger::get(std::string_view name) {
+        if (name.empty()) return global();
+
+        Registry& registry = m_registry();
+        std::lock_guard<std::mutex> guard(registry.lock);
+
+        // walk down from the process-wide logger, creating anything missing along the way
+        Logger* logger = &global();
+        size_t end = 0;
+        while (end != std::string_view::npos) {
+            end = name.find('.', end + 1);
+            const std::string_view path = name.substr(0, end);
+
+            auto found = registry.loggers.find(path);
+            if (found == registry.loggers.end()) {
+                Options opts = *logger->m_options.load();
+                opts.threshold = std::nullopt;
+
+                auto child = std::make_unique<Logger>(opts);
+                child->m_name = std::string(path);
+                child->m_parent = logger;
+                logger->m_children.push_back(child.get());
+                child->m_refreshLevel();
+
+                found = registry.loggers.emplace(child->m_name, std::move(child)).first;
+            }
+
+            logger = found->second.get();
+        }
+
+        return *logger;
+    }
+
+    inline std::vector<std::string> Logger::names() {
+        Registry& registry = m_registry();
+        std::lock_guard<std::mutex> guard(registry.lock);
+
+        std::vector<std::string> names;
+        for (const auto& entry : registry.loggers) names.push_back(entry.first);
+        return names;
+    }
+
+    inline void Logger::configure(const Options& opts) {
+        std::lock_guard<std::mutex> guard(m_registry().lock);
+        Rcu::publish(m_options, static_cast<const Snapshot*>(new Snapshot(opts)));
+        m_refreshLevel();
+    }
+
+    inline void Logger::setLevel(std::optional<Severity> sev) {
+        std::lock_guard<std::mutex> guard(m_registry().lock);
+        Options opts = *m_options.load();
+        opts.threshold = sev;
+        Rcu::publish(m_options, static_cast<const Snapshot*>(new Snapshot(opts)));
+        m_refreshLevel();
+    }
+
+    /*******************
+     *  SINK DISPATCH  *
+     *******************/
+
+    inline Logger::Snapshot::Snapshot(const Options& opts) : Options(opts) {
+        // colored only when every line ends up on a terminal
+        if (color) colored = *color;
+        else {
+            colored = !m_noColor();
+            if (sinks.empty()) colored = colored && StreamSink(std::cout).terminal();
+            m_forEachSink(*this, [this](Sink& sink) { colored = colored && sink.terminal(); });
+        }
+
+        for (size_t sev = 0; sev < m_severityNames.size(); sev++) {
+            prompts[0][sev] = m_compilePrompt(prompt, m_severityNames[sev]);
+            prompts[1][sev] = m_compilePrompt(prompt, m_severityStrings[sev]);
+        }
+    }
+
+    inline void Logger::flush() {
+        Rcu::Guard guard;
+        const Snapshot& opts = *m_options.load();
+
+        {
+            std::lock_guard<std::mutex> lock(m_dedup.lock);
+            m_flushRepeats(opts);
+        }
+
+        if (opts.sinks.empty()) std::cout.flush();
+        m_forEachSink(opts, [](Sink& sink) { sink.flush(); });
+    }
+
+    inline void Logger::sync() {
+        Rcu::Guard guard;
+        const Snapshot& opts = *m_options.load();
+
+        // committers only share the lock long enough to write out held back repeats, so their syncs can
+        // gather into the same group commit
+        {
+            std::lock_guard<std::mutex> lock(m_dedup.lock);
+            m_flushRepeats(opts);
+        }
+
+        if (opts.sinks.empty()) std::cout.flush();
+        m_forEachSink(opts, [](Sink& sink) { sink.sync(); });
+    }
+
+    inline void Logger::m_write(const Options& opts, const Severity& sev, const char* data, size_t len, bool sync) const {
+        const bool durable = opts.syncOn && sev <= *opts.syncOn;
+        const bool flush = durable || sev <= opts.flushOn;
+        sync = sync && durable;
+
+        const auto& sinks = m_sinks(opts, sev);
+        if (sinks.empty()) {
+            std::cout.write(data, static_cast<std::streamsize>(len));
+            if (flush) std::cout.flush();
+            return;
+        }
+
+        for (const auto& sink : sinks) {
+            sink->write(sev, data, len);
+            if (sync) sink->sync();
+            else if (flush) sink->flush();
+        }
+    }
+
+    inline void Logger::m_sync(const Options& opts, const Severity& sev) const {
+        if (!opts.syncOn || sev > *opts.syncOn) return;
+        for (const auto& sink : m_sinks(opts, sev)) sink->sync();
+    }
+
+#if defined(__unix__)
+    /********************
+     *  EMERGENCY PATH  *
+     ********************/
+
+    inline void Logger::m_writeSignalSafe(const Options& opts, const char* data, size_t len) const {
+        const int saved = errno;
+
+        // a single write keeps the line whole, even alongside other writers
+        while (::write(STDERR_FILENO, data, len) < 0 && errno == EINTR) {}
+        for (const auto& sink : m_sinks(opts, FATAL))
+            if (sink->signalSafe()) sink->write(FATAL, data, len);
+
+        errno = saved;
+    }
+
+    inline void Logger::installSignalHandlers() {
+        // stack overflows need somewhere else for the handler to run
+        static char altStack[64 * 1024];
+        stack_t ss = {};
+        ss.ss_sp = altStack;
+        ss.ss_size = sizeof(altStack);
+        ::sigaltstack(&ss, nullptr);
+
+        struct sigaction sa = {};
+        sa.sa_sigaction = &Logger::signalHandler;
+        sa.sa_flags = SA_SIGINFO | SA_ONSTACK | SA_RESETHAND;
+        ::sigemptyset(&sa.sa_mask);
+
+        for (int sig : {SIGSEGV, SIGBUS, SIGFPE, SIGILL, SIGABRT}) ::sigaction(sig, &sa, nullptr);
+    }
+
+    inline void Logger::signalHandler(int sig, siginfo_t* info, void*) {
+        const char* name = "signal";
+        switch (sig) {
+            case SIGSEGV: name = "SIGSEGV"; break;
+            case SIGBUS: name = "SIGBUS"; break;
+            case SIGFPE: name = "SIGFPE"; break;
+            case SIGILL: name = "SIGILL"; break;
+            case SIGABRT: name = "SIGABRT"; break;
+        }
+
+        Logger& logger = global();
+        logger.logSignalSafe("caught @ (@) at @", name, sig, info ? info->si_addr : nullptr);
+
+        // get whatever is still buffered out, as far as that can be done safely
+        m_forEachSink(*logger.m_options.load(), [](Sink& sink) { sink.emergencyFlush(); });
+
+        // and carry on with the default action, which SA_RESETHAND has restored
+        ::raise(sig);
+    }
+#endif
+
+    /*****************
+     *  CONFIG FILE  *
+     *****************/
+
+    /// Logger configuration read from a file of `key = value` lines, where blank lines and lines
+    /// starting with `#` are ignored. Values may be quoted to keep surrounding spaces.
+    ///
+    ///     prompt = " * {sev} | "
+    ///     threshold = INFO
+    ///     flushOn = ERROR
+    ///     sinks = stdout, recorder:/tmp/app.flight:1048576
+    ///     route.ERROR = stderr
+    ///     level.net = WARNING
+    ///     level.net.http = TRACE
+    ///
+    /// The other keys are `formatChar`, `deduplicate`, `repeatInterval` (in milliseconds), `backtrace`, `syncOn` and
+    /// `color` (`true`, `false` or `auto`).
+    /// Each `route.SEVERITY` key sends records of that severity to its own sinks instead.
+    /// Sinks are `stdout`, `stderr` and, on POSIX systems, `file:PATH`, `lz4:PATH` (a compressed file) and
+    /// `recorder:PATH:BYTES`. Prefixing any of them with `async:` writes it from a background thread.
+    class ConfigFile {
+       public:
+        /// Options of the process-wide logger, which named loggers are also given.
+        Logger::Options options;
+
+        /// Levels of named loggers. Named loggers not listed follow their parent.
+        std::map<std::string, std::optional<Logger::Severity>, std::less<>> levels;
+
+        /**
+         * Parses a configuration, throwing `std::runtime_error` naming the offending line on failure.
+         * @param is                            Configuration stream.
+         */
+        static ConfigFile parse(std::istream& is) {
+            ConfigFile config;
+            std::string line;
+            for (size_t number = 1; std::getline(is, line); number++) {
+                const std::string_view text = m_trim(line);
+                if (text.empty() || text.front() == '#') continue;
+
+                const size_t eq = text.find('=');
+                if (eq == std::string_view::npos) m_fail(number, "expected key = value");
+
+                const std::string_view key = m_trim(text.substr(0, eq));
+                std::string_view value = m_trim(text.substr(eq + 1));
+                if (value.size() >= 2 && value.front() == '"' && value.back() == '"') value = value.substr(1, value.size() - 2);
+
+                if (!config.m_set(key, value)) m_fail(number, "invalid " + std::string(key));
+            }
+            return config;
+        }
+
+        /**
+         * Loads a configuration file, throwing `std::runtime_error` if it cannot be read or parsed.
+         * @param path                          Configuration file path.
+         */
+        static ConfigFile load(const std::string& path) {
+            std::ifstream is(path);
+            if (!is) throw std::runtime_error("tiny::ConfigFile: cannot open " + path);
+            return parse(is);
+        }
+
+        /**
+         * Applies the configuration to the process-wide logger and every named logger, creating those
+         * listed. Each logger is swapped over to its new options as a whole, so logging carries on
+         * undisturbed while this happens.
+         */
+        void apply() const {
+            Logger::global().configure(options);
+
+            for (const auto& level : levels) Logger::get(level.first);
+            for (const std::string& name : Logger::names()) {
+                Logger::Options opts = options;
+                const auto found = levels.find(name);
+                opts.threshold = found == levels.end() ? std::nullopt : found->second;
+                Logger::get(name).configure(opts);
+            }
+        }
+
+       private:
+        static std::string_view m_trim(std::string_view str) {
+            const size_t first = str.find_first_not_of(" \t\r");
+            if (first == std::string_view::npos) return {};
+            return str.substr(first, str.find_last_not_of(" \t\r") - first + 1);
+        }
+
+        [[noreturn]] static void m_fail(size_t line, const std::string& what) { throw std::runtime_error("tiny::ConfigFile: line " + std::to_string(line) + ": " + what); }
+
+        static std::optional<Logger::Severity> m_severity(std::string_view name) {
+            static constexpr std::array<std::string_view, 5> NAMES = {"FATAL", "ERROR", "WARNING", "INFO", "TRACE"};
+            for (size_t ii = 0; ii < NAMES.size(); ii++) {
+                if (NAMES[ii].size() != name.size()) continue;
+                if (std::equal(name.begin(), name.end(), NAMES[ii].begin(), [](char a, char b) { return std::toupper(static_cast<unsigned char>(a)) == b; })) return static_cast<Logger::Severity>(ii);
+            }
+            return std::nullopt;
+        }
+
+        static std::optional<unsigned long long> m_number(std::string_view str) {
+            // anything but a whole number in range is left for the caller to report against its line
+            unsigned long long value = 0;
+            const auto res = std::from_chars(str.data(), str.data() + str.size(), value);
+            if (str.empty() || res.ec != std::errc() || res.ptr != str.data() + str.size()) return std::nullopt;
+            return value;
+        }
+
+        static std::shared_ptr<Sink> m_sink(std::string_view spec) {
+            if (spec == "stdout") return std::make_shared<StreamSink>(std::cout);
+            if (spec == "stderr") return std::make_shared<StreamSink>(std::cerr);
+            if (spec.substr(0, 6) == "async:") {
+                const auto target = m_sink(spec.substr(6));
+                return target ? std::make_shared<AsyncSink>(target) : nullptr;
+            }
+#if defined(__unix__)
+            if ((spec.substr(0, 5) == "file:" || spec.substr(0, 4) == "lz4:") && spec.find(':') + 1 < spec.size()) {
+                FileSink::Options opts;
+                opts.path = std::string(spec.substr(spec.find(':') + 1));
+                opts.compress = spec.front() == 'l';
+                return std::make_shared<FileSink>(opts);
+            }
+            if (spec.substr(0, 9) == "recorder:") {
+                const size_t colon = spec.rfind(':');
+                const auto size = m_number(spec.substr(colon + 1));
+                if (colon <= 9 || !size || *size == 0) return nullptr;
+                return std::make_shared<FlightRecorder>(std::string(spec.substr(9, colon - 9)), static_cast<size_t>(*size));
+            }
+#endif
+            return nullptr;
+        }
+
+        /// Parses a comma separated list of sinks, returning whether every one was valid.
+        static bool m_sinkList(std::string_view value, std::vector<std::shared_ptr<Sink>>& sinks) {
+            sinks.clear();
+            while (!value.empty()) {
+                const size_t comma = value.find(',');
+                const auto sink = m_sink(m_trim(value.substr(0, comma)));
+                if (!sink) return false;
+                sinks.push_back(sink);
+                value = comma == std::string_view::npos ? std::string_view() : value.substr(comma + 1);
+            }
+            return true;
+        }
+
+        /// Assigns a single key, returning whether it was valid.
+        bool m_set(std::string_view key, std::string_view value) {
+            if (key == "prompt") options.prompt = std::string(value);
+            else if (key == "formatChar") {
+                if (value.size() != 1) return false;
+                options.formatChar = value.front();
+            } else if (key == "deduplicate") {
+                if (value != "true" && value != "false") return false;
+                options.deduplicate = value == "true";
+            } else if (key == "color") {
+                if (value != "true" && value != "false" && value != "auto") return false;
+                options.color = value == "auto" ? std::nullopt : std::optional<bool>(value == "true");
+            } else if (key == "repeatInterval") {
+                const auto ms = m_number(value);
+                if (!ms) return false;
+                options.repeatInterval = std::chrono::milliseconds(*ms);
+            } else if (key == "backtrace") {
+                const auto count = m_number(value);
+                if (!count) return false;
+                options.backtrace = static_cast<size_t>(*count);
+            } else if (key == "threshold" || key == "flushOn" || key == "syncOn") {
+                const auto sev = m_severity(value);
+                if (!sev) return false;
+                if (key == "flushOn") options.flushOn = *sev;
+                else (key == "threshold" ? options.threshold : options.syncOn) = *sev;
+            } else if (key == "sinks") {
+                return m_sinkList(value, options.sinks);
+            } else if (key.substr(0, 6) == "route.") {
+                const auto sev = m_severity(key.substr(6));
+                return sev && m_sinkList(value, options.routes[*sev]);
+            } else if (key.substr(0, 6) == "level." && key.size() > 6) {
+                const auto sev = m_severity(value);
+                if (!sev && value != "inherit") return false;
+                levels[std::string(key.substr(6))] = sev;
+            } else return false;
+
+            return true;
+        }
+    };
+
+#if defined(__linux__)
+    /// Watches a configuration file with inotify, and applies it again whenever it is rewritten or
+    /// replaced. Reloading happens on the watcher's own thread and never blocks threads that are
+    /// logging. A file that fails to load is reported as an ERROR and the previous configuration is kept.
+    class ConfigWatcher {
+       public:
+        /**
+         * Applies the configuration file and starts watching it. Throws if the file cannot be loaded
+         * the first time, or the watch cannot be set up.
+         * @param path                          Configuration file path.
+         */
+        explicit ConfigWatcher(std::string path) : m_path(std::move(path)) {
+            ConfigFile::load(m_path).apply();
+
+            // the directory is watched, so editors replacing the file are still picked up
+            const size_t slash = m_path.rfind('/');
+            const std::string dir = slash == std::string::npos ? "." : slash == 0 ? "/" : m_path.substr(0, slash);
+            m_name = slash == std::string::npos ? m_path : m_path.substr(slash + 1);
+
+            m_inotify = ::inotify_init1(IN_CLOEXEC | IN_NONBLOCK);
+            if (m_inotify < 0) throw std::system_error(errno, std::generic_category(), "tiny::ConfigWatcher: inotify_init1");
+            if (::inotify_add_watch(m_inotify, dir.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO) < 0) {
+                const int err = errno;
+                ::close(m_inotify);
+                throw std::system_error(err, std::generic_category(), "tiny::ConfigWatcher: inotify_add_watch " + dir);
+            }
+
+            m_wake = ::eventfd(0, EFD_CLOEXEC);
+            if (m_wake < 0) {
+                const int err = errno;
+                ::close(m_inotify);
+                throw std::system_error(err, std::generic_category(), "tiny::ConfigWatcher: eventfd");
+            }
+
+            m_thread = std::thread([this] { m_watch(); });
+        }
+
+        ~ConfigWatcher() {
+            const uint64_t one = 1;
+            (void)!::write(m_wake, &one, sizeof(one));
+            m_thread.join();
+
+            ::close(m_wake);
+            ::close(m_inotify);
+        }
+
+        ConfigWatcher(const ConfigWatcher&) = delete;
+        ConfigWatcher& operator=(const ConfigWatcher&) = delete;
+
+       private:
+        std::string m_path;
+        std::string m_name;
+        int m_inotify = -1;
+        int m_wake = -1;
+        std::thread m_thread;
+
+        void m_watch() {
+            pollfd fds[2] = {{m_inotify, POLLIN, 0}, {m_wake, POLLIN, 0}};
+            while (true) {
+                if (::poll(fds, 2, -1) < 0) {
+                    if (errno == EINTR) continue;
+                    return;
+                }
+                if (fds[1].revents) return;
+
+                // drain every pending event, and reload once if any of them were for the file
+                bool changed = false;
+                alignas(inotify_event) char buffer[4096];
+                ssize_t len;
+                while ((len = ::read(m_inotify, buffer, sizeof(buffer))) > 0) {
+                    for (char* at = buffer; at < buffer + len;) {
+                        const inotify_event* event = reinterpret_cast<const inotify_event*>(at);
+                        if (event->len > 0 && m_name == event->name) changed = true;
+                        at += sizeof(inotify_event) + event->len;
+                    }
+                }
+
+                if (changed) m_reload();
+            }
+        }
+
+        void m_reload() {
+            try {
+                ConfigFile::load(m_path).apply();
+            } catch (const std::exception& e) {
+                Logger::global().log(Logger::ERROR, "@", e.what());
+            }
+        }
+    };
+#endif
+
+    /*******************
+     *  CORE LOGGABLE  *
+     *******************/
+
+    /// Helper Loggable Abstract Class. Aids in making
+    /// derived classes be loggable.
+    class Loggable {
+       public:
+        /// Make a pure virtual class.
+        virtual ~Loggable() = default;
+
+        /// Virtualized stringification method.
+        virtual std::string toString() const = 0;
+
+        /**
+         * Use the friend keyword to modify the core output stream operator for
+         * simple printing of derived classes.
+         * @param os                                Base Output Stream.
          * @param self                              Loggable Instance.
          */
         friend std::ostream& operator<<(std::ostream& os, const Loggable& self) {
@@ -206,11 +4145,21 @@ namespace tiny {
  *  HELPER MACROS  *
  *******************/
 
-#define TL_FATAL(FMT, ...) ::tiny::Logger::log(::tiny::Logger::FATAL, FMT, ##__VA_ARGS__)
-#define TL_ERROR(FMT, ...) ::tiny::Logger::log(::tiny::Logger::ERROR, FMT, ##__VA_ARGS__)
-#define TL_WARNING(FMT, ...) ::tiny::Logger::log(::tiny::Logger::WARNING, FMT, ##__VA_ARGS__)
-#define TL_INFO(FMT, ...) ::tiny::Logger::log(::tiny::Logger::INFO, FMT, ##__VA_ARGS__)
-#define TL_TRACE(FMT, ...) ::tiny::Logger::log(::tiny::Logger::TRACE, FMT, ##__VA_ARGS__)
-#define TL_VALUE(...) ::tiny::Logger::logValue(__VA_ARGS__)
+// Source Location, with the directory stripped at compile time
+#if defined(__FILE_NAME__)
+    #define TL_LOCATION ::tiny::Location{__FILE_NAME__, __LINE__, __func__}
+#else
+    #define TL_LOCATION ::tiny::Location{__FILE__ + std::integral_constant<size_t, ::tiny::Location::basename(__FILE__)>::value, __LINE__, __func__}
+#endif
+
+#define TL_FATAL(FMT, ...) ::tiny::Logger::global().log(TL_LOCATION, ::tiny::Logger::FATAL, FMT, ##__VA_ARGS__)
+#define TL_ERROR(FMT, ...) ::tiny::Logger::global().log(TL_LOCATION, ::tiny::Logger::ERROR, FMT, ##__VA_ARGS__)
+#define TL_WARNING(FMT, ...) ::tiny::Logger::global().log(TL_LOCATION, ::tiny::Logger::WARNING, FMT, ##__VA_ARGS__)
+#define TL_INFO(FMT, ...) ::tiny::Logger::global().log(TL_LOCATION, ::tiny::Logger::INFO, FMT, ##__VA_ARGS__)
+#define TL_TRACE(FMT, ...) ::tiny::Logger::global().log(TL_LOCATION, ::tiny::Logger::TRACE, FMT, ##__VA_ARGS__)
+#define TL_VALUE(...) ::tiny::Logger::global().logValue(__VA_ARGS__)
+
+// Async-signal-safe Wrapper
+#define TL_FATAL_SAFE(FMT, ...) ::tiny::Logger::global().logSignalSafe(TL_LOCATION, FMT, ##__VA_ARGS__)
 
 #endif
\ No newline at end of file